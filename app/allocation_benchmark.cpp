@@ -0,0 +1,165 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <stdexcept>
+#include "../include/graph/graph.hpp"
+#include "../include/graph/graph_builder.hpp"
+#include "../include/parser/reader.hpp"
+#include "../include/algorithm/queue.hpp"
+#include "../include/algorithm/workspace.hpp"
+#include "../include/algorithm/astar.hpp"
+#include "../include/algorithm/dijkstra.hpp"
+
+using namespace graph;
+using namespace algorithm;
+
+// Counting allocator: every global allocation in the process goes through these operators
+static std::atomic<std::size_t> allocation_count(0);
+
+[[gnu::noinline]] void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    ::operator delete(pointer);
+}
+
+// Random graph with integer costs, every vertex gets at least one outgoing edge
+CSRGraph<double> generate_graph(unsigned int num_vertices, unsigned int num_edges, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::uniform_int_distribution<unsigned int> vertex(0, num_vertices - 1);
+    std::uniform_int_distribution<int> cost(1, 100);
+
+    GraphBuilder<double> builder;
+    for (unsigned int i = 0; i < num_vertices; i++)
+        builder.add_vertex(i, coordinate(rng), coordinate(rng));
+    for (unsigned int i = 0; i < num_edges; i++)
+        builder.add_edge(i % num_vertices, vertex(rng), cost(rng));
+    return builder.build();
+}
+
+struct Measurement
+{
+    std::size_t operations = 0;
+    std::size_t allocations = 0;
+};
+
+void report(const std::string &name, const std::string &unit, const Measurement &measurement, bool must_be_zero, bool &passed)
+{
+    double per_operation = measurement.operations ? double(measurement.allocations) / measurement.operations : 0;
+    bool ok = !must_be_zero || measurement.allocations == 0;
+    passed = passed && ok;
+    std::cout << "  " << std::left << std::setw(34) << name << std::right << std::setw(12) << measurement.operations << " " << std::left
+              << std::setw(12) << unit << std::right << std::setw(12) << measurement.allocations << std::setw(14) << std::setprecision(6)
+              << per_operation << (must_be_zero ? (ok ? "  ok" : "  FAIL") : "") << std::endl;
+}
+
+// Full Dijkstra runs on a warm workspace, the queue storage has already grown to fit every query
+template <class Queue>
+Measurement measure_dijkstra(const CSRGraph<double> &csr, const std::vector<unsigned int> &starts)
+{
+    SearchWorkspace<Queue> workspace(csr.get_num_vertices());
+    DijkstraQuery query;
+    for (auto start : starts)
+        run_dijkstra(csr, start, query, workspace); // Warm up the queue storage on the same queries
+
+    Measurement measurement;
+    std::size_t before = allocation_count.load();
+    for (auto start : starts)
+        measurement.operations += run_dijkstra(csr, start, query, workspace).relaxed_edges;
+    measurement.allocations = allocation_count.load() - before;
+    return measurement;
+}
+
+// A* queries on a warm workspace, one allocation per query is expected for the returned path
+Measurement measure_astar(const CSRGraph<double> &csr, const std::vector<unsigned int> &starts)
+{
+    SearchWorkspace<> workspace(csr.get_num_vertices());
+    for (std::size_t i = 0; i + 1 < starts.size(); i++)
+        find_astar_path(csr, starts[i], starts[i + 1], workspace); // Warm up the queue and scratch buffers
+
+    Measurement measurement;
+    std::size_t before = allocation_count.load();
+    for (std::size_t i = 0; i + 1 < starts.size(); i++)
+        find_astar_path(csr, starts[i], starts[i + 1], workspace);
+    measurement.allocations = allocation_count.load() - before;
+    measurement.operations = starts.size() - 1;
+    return measurement;
+}
+
+// Neighbor iteration over the vertex and edge objects
+Measurement measure_objects(const Graph<double> &graph)
+{
+    Measurement measurement;
+    double total = 0;
+    std::size_t before = allocation_count.load();
+    for (const auto &vertex : graph.get_vertices())
+    {
+        vertex.second->for_each_neighbor([&](Vertex<double> *neighbor, Edge<double> *edge)
+                                         { total += edge->get_cost() + neighbor->get_x(); measurement.operations++; });
+        for (const auto &edge : vertex.second->get_edges())
+            total += edge->get_cost();
+    }
+    measurement.allocations = allocation_count.load() - before;
+    if (total < 0)
+        std::cout << total << std::endl; // Keep the loop from being optimized out
+    return measurement;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        CSRGraph<double> csr;
+        if (argc > 1)
+        {
+            GraphBuilder<double> builder;
+            parser::GraphFileReader<double> gf_reader(argv[1], builder);
+            csr = builder.build();
+        }
+        else
+            csr = generate_graph(100000, 500000, 1);
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<unsigned int> index(0, csr.get_num_vertices() - 1);
+        std::vector<unsigned int> starts;
+        for (unsigned int i = 0; i < 20; i++)
+            starts.push_back(csr.get_position(index(rng)));
+
+        Graph<double> graph(csr);
+        graph.materialize();
+
+        std::cout << "Heap allocations (" << csr.get_num_vertices() << " vertices, " << csr.get_num_edges() << " edges)" << std::endl;
+        std::cout << "  " << std::left << std::setw(34) << "operation" << std::right << std::setw(12) << "count" << " " << std::left
+                  << std::setw(12) << "" << std::right << std::setw(12) << "allocations" << std::setw(14) << "per op" << std::endl;
+        bool passed = true;
+        report("dijkstra, 4-ary heap", "relaxations", measure_dijkstra<QuadHeap>(csr, starts), true, passed);
+        report("dijkstra, binary heap", "relaxations", measure_dijkstra<DaryHeap<2>>(csr, starts), true, passed);
+        report("dijkstra, pairing heap", "relaxations", measure_dijkstra<PairingHeap>(csr, starts), true, passed);
+        report("dijkstra, radix heap", "relaxations", measure_dijkstra<RadixHeap>(csr, starts), true, passed);
+        report("vertex neighbor iteration", "neighbors", measure_objects(graph), true, passed);
+        report("a*, path result included", "queries", measure_astar(csr, starts), false, passed);
+        return passed ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include "../include/graph/graph_builder.hpp"
+#include "../include/graph/dynamic_costs.hpp"
+#include "../include/algorithm/astar.hpp"
+
+using namespace graph;
+using namespace algorithm;
+
+// Random graph with integer costs, every vertex gets at least one outgoing edge
+CSRGraph<double> generate_graph(unsigned int num_vertices, unsigned int num_edges, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::uniform_int_distribution<unsigned int> vertex(0, num_vertices - 1);
+    std::uniform_int_distribution<int> cost(1, 100);
+
+    GraphBuilder<double> builder;
+    for (unsigned int i = 0; i < num_vertices; i++)
+        builder.add_vertex(i, coordinate(rng), coordinate(rng));
+    for (unsigned int i = 0; i < num_edges; i++)
+        builder.add_edge(i % num_vertices, vertex(rng), cost(rng));
+    return builder.build();
+}
+
+// Every edge of the watched (source, target) pairs, by edge index
+std::vector<std::size_t> find_watched_edges(const CSRGraph<double> &csr, const std::vector<EdgeCostUpdate> &batch)
+{
+    std::vector<std::size_t> edges;
+    for (const auto &update : batch)
+    {
+        auto source = csr.get_index(update.source);
+        auto target = csr.get_index(update.target);
+        for (auto edge = csr.edges_begin(source); edge != csr.edges_end(source); edge++)
+        {
+            if (csr.get_target(edge) == target)
+                edges.push_back(edge);
+        }
+    }
+    return edges;
+}
+
+// A retired version must be freed by the release of its last snapshot, without another publish
+bool check_reclaim_on_release(const CSRGraph<double> &csr, const EdgeCostUpdate &update)
+{
+    DynamicCosts<double> costs(csr);
+    CostSnapshot snapshot = costs.pin();
+    costs.update_costs({{update.source, update.target, 5000}});
+    bool held = costs.get_num_retired() == 1;
+    snapshot = CostSnapshot();
+    return held && costs.get_num_retired() == 0;
+}
+
+// Readers pin versions and run A* on them while a writer publishes batches that set every watched edge
+// to the same cost. A snapshot mixing two batches, a version going backwards or a retired version that
+// outlives its readers fails the run. Build with -fsanitize=thread or address to check the memory side.
+int main(int argc, char **argv)
+{
+    try
+    {
+        const unsigned int num_readers = argc > 1 ? std::stoul(argv[1]) : 4;
+        const unsigned int num_batches = argc > 2 ? std::stoul(argv[2]) : 2000;
+        const unsigned int num_watched = 300;
+
+        CSRGraph<double> csr = generate_graph(20000, 100000, 1);
+        DynamicCosts<double> costs(csr);
+
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<unsigned int> index(0, csr.get_num_vertices() - 1);
+        std::vector<EdgeCostUpdate> batch;
+        while (batch.size() < num_watched)
+        {
+            auto source = index(rng);
+            if (csr.edges_begin(source) == csr.edges_end(source))
+                continue;
+            EdgeCostUpdate update{csr.get_position(source), csr.get_position(csr.get_target(csr.edges_begin(source))), 0};
+            bool duplicate = std::any_of(batch.begin(), batch.end(), [&](const EdgeCostUpdate &other)
+                                         { return other.source == update.source && other.target == update.target; });
+            if (!duplicate)
+                batch.push_back(update);
+        }
+        const std::vector<std::size_t> watched = find_watched_edges(csr, batch);
+        for (auto &update : batch)
+            update.cost = 1000;
+        costs.update_costs(batch);
+
+        std::atomic<bool> done(false);
+        std::atomic<std::size_t> torn(0), backwards(0), queries(0);
+        auto reader = [&](unsigned int seed)
+        {
+            std::mt19937 reader_rng(seed);
+            SearchWorkspace<> workspace(csr.get_num_vertices());
+            EuclideanHeuristic<double> heuristic(csr);
+            std::uint64_t last_version = 0;
+            while (!done.load())
+            {
+                const CostSnapshot snapshot = costs.pin();
+                if (snapshot.get_version() < last_version)
+                    backwards++;
+                last_version = snapshot.get_version();
+                const double expected = snapshot.get_cost(watched[0]);
+                for (auto edge : watched)
+                {
+                    if (snapshot.get_cost(edge) != expected)
+                        torn++;
+                }
+                find_astar_path(csr, csr.get_position(index(reader_rng)), csr.get_position(index(reader_rng)), workspace, heuristic, snapshot);
+                for (auto edge : watched)
+                {
+                    if (snapshot.get_cost(edge) != expected)
+                        torn++;
+                }
+                queries++;
+            }
+        };
+
+        std::vector<std::thread> readers;
+        for (unsigned int i = 0; i < num_readers; i++)
+            readers.emplace_back(reader, i + 1);
+        for (unsigned int b = 0; b < num_batches; b++)
+        {
+            for (auto &update : batch)
+                update.cost = 1001 + b;
+            costs.update_costs(batch);
+        }
+        done.store(true);
+        for (auto &thread : readers)
+            thread.join();
+
+        const bool reclaimed = costs.get_num_retired() == 0;
+        const bool released = check_reclaim_on_release(csr, batch[0]);
+        std::cout << num_readers << " readers ran " << queries.load() << " A* queries during " << num_batches << " batches of "
+                  << watched.size() << " edges" << std::endl;
+        std::cout << "  torn reads: " << torn.load() << ", versions going backwards: " << backwards.load() << std::endl;
+        std::cout << "  retired versions left after the readers: " << costs.get_num_retired() << (reclaimed ? "  ok" : "  FAIL") << std::endl;
+        std::cout << "  version freed by its last snapshot release: " << (released ? "ok" : "FAIL") << std::endl;
+        return torn.load() == 0 && backwards.load() == 0 && reclaimed && released ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <getopt.h>
+#include "../include/graph/graph_builder.hpp"
+#include "../include/parser/reader.hpp"
+#include "../include/parser/snapshot.hpp"
+#include "../include/algorithm/landmarks.hpp"
+
+using namespace graph;
+using namespace parser;
+
+void print_usage(const char *program)
+{
+    std::cerr << "Usage: " << program << " -i <input graph> -o <output snapshot> [-k <landmarks>]" << std::endl;
+    std::cerr << "  -i  Text graph file to convert" << std::endl;
+    std::cerr << "  -o  Binary snapshot to write" << std::endl;
+    std::cerr << "  -k  Also embed an ALT landmark table with this many landmarks" << std::endl;
+}
+
+// Converts a text graph file into a binary snapshot that path_finder maps without parsing
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string input_file, output_file;
+        unsigned int num_landmarks = 0;
+
+        int option;
+        while ((option = getopt(argc, argv, "i:o:k:h")) != -1)
+        {
+            switch (option)
+            {
+            case 'i':
+                input_file = optarg;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'k':
+                try
+                {
+                    num_landmarks = std::stoul(optarg);
+                }
+                catch (const std::exception &)
+                {
+                    throw std::invalid_argument("Invalid landmark count: " + std::string(optarg));
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        if (input_file.empty() || output_file.empty())
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        GraphBuilder<double> builder;
+        GraphFileReader<double> reader(input_file, builder);
+        CSRGraph<double> csr = builder.build();
+
+        std::vector<SnapshotExtra> extras;
+        if (num_landmarks > 0)
+        {
+            std::ostringstream stream;
+            algorithm::LandmarkTable<double>(csr, num_landmarks).save(stream, csr);
+            extras.push_back(SnapshotExtra{SnapshotSection::LANDMARKS, stream.str()});
+        }
+
+        write_snapshot(output_file, csr, reader.get_start_end(), extras);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "Wrote " << csr.get_num_vertices() << " vertices and " << csr.get_num_edges() << " edges to "
+                  << output_file << " in " << elapsed << " s" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -5,17 +5,139 @@
 #include <stdexcept>
 #include <QApplication>
 #include "../include/graph/graph.hpp"
+#include "../include/graph/graph_builder.hpp"
 #include "../include/parser/reader.hpp"
+#include "../include/parser/snapshot.hpp"
 #include "../include/parser/writer.hpp"
 #include "../include/interface/cli.hpp"
 #include "../include/interface/window.hpp"
 #include "../include/algorithm/astar.hpp"
 #include "../include/algorithm/dijkstra.hpp"
+#include "../include/algorithm/bidirectional.hpp"
+#include "../include/algorithm/contraction_hierarchy.hpp"
+#include "../include/algorithm/landmarks.hpp"
+#include "../include/algorithm/batch.hpp"
+#include "../include/algorithm/delta_stepping.hpp"
+#include "../include/algorithm/distance_matrix.hpp"
+#include "../include/parser/query_reader.hpp"
+#include "../include/parallel/thread_pool.hpp"
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <functional>
+#include <unordered_set>
+#include <chrono>
 
 using namespace graph;
 using namespace parser;
 using namespace interface;
 
+// Solve every query of the batch file on a thread pool and stream the results to the output file
+void solve_batch(const CLIInterface &cli, Graph<double> &main_graph, const algorithm::LandmarkTable<double> &landmarks, bool use_landmarks)
+{
+    using Solver = std::function<std::vector<unsigned int>(unsigned int, unsigned int)>;
+    const std::string algorithm = cli.get_algorithm();
+    QueryFileReader query_reader(cli.get_batch_file());
+
+    // Coordinate queries are snapped to their nearest vertices through the spatial index
+    if (query_reader.has_point_queries())
+        query_reader.resolve_points([&](double x, double y)
+                                    { return main_graph.find_nearest_vertex(x, y); });
+
+    // The CSR is built here once, the workers only read it
+    const auto &csr = main_graph.get_csr();
+    std::unique_ptr<algorithm::ContractionHierarchy<double>> hierarchy;
+    if (algorithm == "ch")
+        hierarchy = std::make_unique<algorithm::ContractionHierarchy<double>>(csr);
+
+    // Every worker gets a solver owning its own workspace
+    auto make_solver = [&]() -> Solver
+    {
+        if (algorithm == "dijkstra")
+            return [&csr, workspace = algorithm::SearchWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_dijkstra_path(csr, start, end, workspace); };
+        if (algorithm == "astar" && use_landmarks)
+            return [&csr, &landmarks, workspace = algorithm::SearchWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_astar_path(csr, start, end, workspace, landmarks); };
+        if (algorithm == "astar")
+            return [&csr, workspace = algorithm::SearchWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_astar_path(csr, start, end, workspace); };
+        if (algorithm == "bidijkstra")
+            return [&csr, workspace = algorithm::BidirectionalWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_bidirectional_dijkstra_path(csr, start, end, workspace); };
+        if (algorithm == "biastar" && use_landmarks)
+            return [&csr, &landmarks, workspace = algorithm::BidirectionalWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_bidirectional_astar_path(csr, start, end, workspace, landmarks); };
+        if (algorithm == "biastar")
+            return [&csr, workspace = algorithm::BidirectionalWorkspace<>()](unsigned int start, unsigned int end) mutable
+            { return algorithm::find_bidirectional_astar_path(csr, start, end, workspace); };
+        return [&csr, &hierarchy, workspace = algorithm::BidirectionalWorkspace<>()](unsigned int start, unsigned int end) mutable
+        { return algorithm::find_contraction_hierarchy_path(csr, *hierarchy, start, end, workspace); };
+    };
+
+    const unsigned int num_threads = cli.get_num_threads() ? cli.get_num_threads() : std::thread::hardware_concurrency();
+    parallel::ThreadPool pool(num_threads);
+    algorithm::BatchQueryEngine<double> engine(csr, pool);
+    engine.set_connectivity(&main_graph.get_connectivity());
+    // Results are formatted on this thread while a writer thread drains the full buffers to disk
+    GraphFileWriter<double> gf_writer(cli.get_output_file(), true);
+    gf_writer.write_batch_header();
+
+    auto begin = std::chrono::steady_clock::now();
+    engine.run(query_reader.get_queries(), make_solver, [&](const algorithm::BatchResult &result)
+               { gf_writer.write_batch_result(result.start_position, result.end_position, result.cost, result.path); });
+    gf_writer.close();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    std::cout << "Solved " << query_reader.get_queries().size() << " queries on " << pool.get_num_threads()
+              << " threads in " << elapsed.count() << " s" << std::endl;
+}
+
+// Compute the costs from the start to the end vertices of the query file and write the matrix to the output file
+void solve_matrix(const CLIInterface &cli, Graph<double> &main_graph)
+{
+    QueryFileReader query_reader(cli.get_matrix_file());
+    if (query_reader.has_point_queries())
+        query_reader.resolve_points([&](double x, double y)
+                                    { return main_graph.find_nearest_vertex(x, y); });
+
+    // Rows are the distinct start vertices and columns the distinct end vertices, in file order
+    std::vector<unsigned int> sources, targets;
+    std::unordered_set<unsigned int> seen_sources, seen_targets;
+    for (const auto &query : query_reader.get_queries())
+    {
+        if (seen_sources.insert(std::get<0>(query)).second)
+            sources.push_back(std::get<0>(query));
+        if (seen_targets.insert(std::get<1>(query)).second)
+            targets.push_back(std::get<1>(query));
+    }
+
+    const unsigned int num_threads = cli.get_num_threads() ? cli.get_num_threads() : std::thread::hardware_concurrency();
+    parallel::ThreadPool pool(num_threads);
+    auto begin = std::chrono::steady_clock::now();
+    algorithm::DistanceMatrix matrix;
+    if (cli.get_algorithm() == "ch")
+    {
+        algorithm::ContractionHierarchy<double> hierarchy(main_graph.get_csr());
+        matrix = algorithm::distance_matrix(main_graph.get_csr(), hierarchy, sources, targets, pool);
+    }
+    else
+        matrix = algorithm::distance_matrix(main_graph, sources, targets, pool);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    // Output files ending in .bin get the binary matrix, the others the text one
+    const std::string output_file = cli.get_output_file();
+    if (output_file.size() >= 4 && output_file.compare(output_file.size() - 4, 4, ".bin") == 0)
+        write_binary_matrix(output_file, matrix.get_num_rows(), matrix.get_num_columns(), matrix.costs);
+    else
+    {
+        GraphFileWriter<double> gf_writer(output_file);
+        gf_writer.write_matrix(matrix.sources, matrix.targets, matrix.costs);
+        gf_writer.close();
+    }
+    std::cout << "Computed a " << matrix.get_num_rows() << " x " << matrix.get_num_columns() << " distance matrix on " << pool.get_num_threads()
+              << " threads in " << elapsed.count() << " s" << std::endl;
+}
+
 int main(int argc, char **argv)
 {
     try
@@ -25,37 +147,147 @@ int main(int argc, char **argv)
         const std::string input_file = cli.get_input_file();
         const std::string output_file = cli.get_output_file();
         const bool path_only = cli.get_path_only();
+        const bool use_landmarks = cli.get_heuristic() == "alt";
 
-        GraphFileReader<double> gf_reader(input_file);
+        // Binary snapshots are mapped and served as they are, text files are parsed
+        std::tuple<unsigned int, unsigned int> start_end;
+        std::string_view snapshot_landmarks;
+        GraphSnapshot<double> snapshot;
+        auto load_graph = [&]() -> Graph<double>
+        {
+            if (is_snapshot(input_file))
+            {
+                snapshot = load_snapshot<double>(input_file);
+                start_end = snapshot.start_end;
+                if (snapshot.has_section(SnapshotSection::LANDMARKS))
+                    snapshot_landmarks = snapshot.get_section(SnapshotSection::LANDMARKS);
+                return Graph<double>(snapshot.csr);
+            }
+            GraphBuilder<double> builder;
+            GraphFileReader<double> gf_reader(input_file, builder, cli.get_num_threads());
+            start_end = gf_reader.get_start_end();
+            return Graph<double>(builder.build());
+        };
+        Graph<double> main_graph = load_graph();
 
         unsigned int start, end;
-        auto vertices = gf_reader.get_vertices();
-        auto edges = gf_reader.get_edges();
-        std::tie(start, end) = gf_reader.get_start_end();
+        std::tie(start, end) = start_end;
 
-        Graph<double> main_graph(vertices, edges);
+        // Coordinates given on the command line replace the file's endpoints by their nearest vertices
+        auto snap = [&](const std::tuple<double, double> &point, const char *name)
+        {
+            double x, y;
+            std::tie(x, y) = point;
+            unsigned int position = main_graph.find_nearest_vertex(x, y);
+            std::cout << "Snapped " << name << " (" << x << ", " << y << ") to vertex " << position << std::endl;
+            return position;
+        };
+        if (cli.has_start_point())
+            start = snap(cli.get_start_point(), "start");
+        if (cli.has_end_point())
+            end = snap(cli.get_end_point(), "end");
+        start_end = std::make_tuple(start, end);
+
+        // ALT landmarks are loaded from the landmark file when it exists, then from the snapshot,
+        // otherwise computed (and saved)
+        algorithm::LandmarkTable<double> landmarks;
+        if (use_landmarks)
+        {
+            const std::string landmark_file = cli.get_landmark_file();
+            if (!landmark_file.empty() && std::ifstream(landmark_file).good())
+                landmarks = algorithm::LandmarkTable<double>::load(landmark_file, main_graph.get_csr());
+            else if (!snapshot_landmarks.empty())
+            {
+                std::istringstream stream{std::string(snapshot_landmarks)};
+                landmarks = algorithm::LandmarkTable<double>::load(stream, main_graph.get_csr(), input_file);
+            }
+            else
+            {
+                landmarks = algorithm::LandmarkTable<double>(main_graph.get_csr(), cli.get_num_landmarks());
+                if (!landmark_file.empty())
+                    landmarks.save(landmark_file, main_graph.get_csr());
+            }
+        }
+        if (!cli.get_batch_file().empty())
+        {
+            solve_batch(cli, main_graph, landmarks, use_landmarks);
+            return 0;
+        }
+        if (!cli.get_matrix_file().empty())
+        {
+            solve_matrix(cli, main_graph);
+            return 0;
+        }
+
+        // The display and the path output work on vertex objects
+        main_graph.materialize();
+
+        // Statistics are collected from the A* and Dijkstra queries when requested
+        std::vector<algorithm::SearchStats> search_stats;
+        algorithm::SearchWorkspace<> workspace;
+        if (cli.get_print_stats())
+            workspace.set_stats_callback([&](const algorithm::SearchStats &stats)
+                                         { search_stats.push_back(stats); });
+
+        auto compute_astar = [&]()
+        {
+            if (use_landmarks)
+                algorithm::compute_astar(main_graph, start, end, workspace, landmarks);
+            else
+                algorithm::compute_astar(main_graph, start, end, workspace);
+        };
 
         if (algorithm == "astar")
-            algorithm::compute_astar(main_graph, start, end);
+            compute_astar();
         if (algorithm == "dijkstra")
-            algorithm::compute_dijkstra(main_graph, start, end);
+            algorithm::compute_dijkstra(main_graph, start, end, workspace);
+        if (algorithm == "biastar")
+        {
+            if (use_landmarks)
+            {
+                algorithm::BidirectionalWorkspace<> workspace;
+                algorithm::compute_bidirectional_astar(main_graph, start, end, workspace, landmarks);
+            }
+            else
+                algorithm::compute_bidirectional_astar(main_graph, start, end);
+        }
+        if (algorithm == "bidijkstra")
+            algorithm::compute_bidirectional_dijkstra(main_graph, start, end);
+        if (algorithm == "ch")
+        {
+            algorithm::ContractionHierarchy<double> hierarchy(main_graph.get_csr());
+            algorithm::compute_contraction_hierarchy(main_graph, hierarchy, start, end);
+        }
+        if (algorithm == "deltastep")
+        {
+            const unsigned int num_threads = cli.get_num_threads() ? cli.get_num_threads() : std::thread::hardware_concurrency();
+            parallel::ThreadPool pool(num_threads);
+            algorithm::DeltaSteppingOptions options;
+            options.delta = cli.get_bucket_width();
+            algorithm::compute_delta_stepping(main_graph, start, end, workspace, pool, options);
+        }
         if (algorithm == "all")
         {
-            algorithm::compute_astar(main_graph, start, end);
-            algorithm::compute_dijkstra(main_graph, start, end);
+            compute_astar();
+            algorithm::compute_dijkstra(main_graph, start, end, workspace);
         }
-        auto astar_path = main_graph.get_astar_path();
-        auto dijkstra_path = main_graph.get_dijkstra_path();
-        
-        if (astar_path.empty() && (algorithm == "astar" || algorithm == "all"))
+        if (cli.get_print_stats())
+            algorithm::write_stats_json(std::cout, search_stats);
+        const auto &astar_path = main_graph.get_astar_path();
+        const auto &dijkstra_path = main_graph.get_dijkstra_path();
+        const bool uses_astar = algorithm == "astar" || algorithm == "biastar" || algorithm == "all";
+        const bool uses_dijkstra = algorithm == "dijkstra" || algorithm == "bidijkstra" || algorithm == "ch" || algorithm == "deltastep" ||
+                                   algorithm == "all";
+
+        if (astar_path.empty() && uses_astar)
             std::cout << "No path found using A*" << std::endl;
-        if (dijkstra_path.empty() && (algorithm == "dijkstra" || algorithm == "all"))
+        if (dijkstra_path.empty() && uses_dijkstra)
             std::cout << "No path found using Dijkstra" << std::endl;
 
         if (!output_file.empty())
         {
             GraphFileWriter<double> gf_writer(output_file);
-            gf_writer.write_start_end(gf_reader.get_start_end());
+            gf_writer.write_start_end(start_end);
             if (!astar_path.empty())
             {
                 gf_writer.write_edges(main_graph.get_path_edge_elements(astar_path), "A*");
@@ -70,11 +302,12 @@ int main(int argc, char **argv)
                 auto dijkstra_distance = main_graph.get_path_distance(dijkstra_path);
                 gf_writer.write_cost_distance(dijkstra_cost, dijkstra_distance);
             }
+            gf_writer.close();
         }
 
         QApplication app(argc, argv);
         MainWindow<double> main_window;
-        main_window.set_graph(main_graph);
+        main_window.set_graph(std::move(main_graph));
         main_window.draw_graph(50, path_only);
         main_window.show();
         return app.exec();
@@ -0,0 +1,411 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <stdexcept>
+#include <getopt.h>
+#include "../include/graph/graph.hpp"
+#include "../include/graph/graph_builder.hpp"
+#include "../include/parser/reader.hpp"
+#include "../include/generator/random_graph.hpp"
+#include "../include/generator/graph_output.hpp"
+#include "../include/algorithm/workspace.hpp"
+#include "../include/algorithm/astar.hpp"
+#include "../include/algorithm/dijkstra.hpp"
+#include "../include/algorithm/contraction_hierarchy.hpp"
+#include "../include/algorithm/distance_matrix.hpp"
+#include "../include/parallel/thread_pool.hpp"
+
+using namespace graph;
+using namespace algorithm;
+
+using Clock = std::chrono::steady_clock;
+using VertexElements = Graph<double>::VertexElements;
+using EdgeElements = Graph<double>::EdgeElements;
+
+// Sources and targets of the measured distance matrices
+constexpr std::size_t MATRIX_SIZE = 32;
+// Contraction takes minutes on the synthetic graphs, so the hierarchy matrix is measured on small graphs only
+constexpr std::size_t MAX_HIERARCHY_VERTICES = 5000;
+
+struct BenchOptions
+{
+    std::string output_file;
+    unsigned int num_queries = 200;
+    unsigned int repetitions = 5;
+    bool synthetic = true;
+    std::vector<std::string> input_files;
+};
+
+// Summary of repeated measurements, in the unit they were taken in
+struct Distribution
+{
+    std::size_t count = 0;
+    double mean = 0;
+    double min = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+// Nearest-rank percentiles
+Distribution summarize(std::vector<double> samples)
+{
+    Distribution distribution;
+    if (samples.empty())
+        return distribution;
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p)
+    {
+        std::size_t rank = static_cast<std::size_t>(p / 100 * samples.size() + 0.999999);
+        return samples[std::clamp<std::size_t>(rank, 1, samples.size()) - 1];
+    };
+    distribution.count = samples.size();
+    for (double sample : samples)
+        distribution.mean += sample;
+    distribution.mean /= samples.size();
+    distribution.min = samples.front();
+    distribution.p50 = percentile(50);
+    distribution.p90 = percentile(90);
+    distribution.p99 = percentile(99);
+    distribution.max = samples.back();
+    return distribution;
+}
+
+double elapsed(Clock::time_point begin, Clock::time_point end, double scale)
+{
+    return std::chrono::duration<double>(end - begin).count() * scale;
+}
+
+std::string quote(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20)
+            quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string to_json(const Distribution &distribution)
+{
+    std::ostringstream out;
+    out << std::setprecision(6) << "{\"count\": " << distribution.count << ", \"mean\": " << distribution.mean
+        << ", \"min\": " << distribution.min << ", \"p50\": " << distribution.p50 << ", \"p90\": " << distribution.p90
+        << ", \"p99\": " << distribution.p99 << ", \"max\": " << distribution.max << "}";
+    return out.str();
+}
+
+// One benchmarked graph, as a JSON object
+struct GraphResult
+{
+    std::string name;
+    std::string source;
+    std::size_t num_vertices = 0;
+    std::size_t num_edges = 0;
+    Distribution parse_ms;
+    Distribution build_ms;
+    Distribution astar_us;
+    Distribution dijkstra_us;
+    Distribution matrix_ms;
+    Distribution hierarchy_matrix_ms;
+    std::size_t paths_found = 0;
+};
+
+std::string to_json(const GraphResult &result)
+{
+    std::ostringstream out;
+    out << "    {\n"
+        << "      \"name\": " << quote(result.name) << ",\n"
+        << "      \"source\": " << quote(result.source) << ",\n"
+        << "      \"vertices\": " << result.num_vertices << ",\n"
+        << "      \"edges\": " << result.num_edges << ",\n"
+        << "      \"parse_ms\": " << to_json(result.parse_ms) << ",\n"
+        << "      \"build_ms\": " << to_json(result.build_ms) << ",\n"
+        << "      \"astar_us\": " << to_json(result.astar_us) << ",\n"
+        << "      \"dijkstra_us\": " << to_json(result.dijkstra_us) << ",\n"
+        << "      \"matrix_ms\": " << to_json(result.matrix_ms) << ",\n"
+        << "      \"hierarchy_matrix_ms\": " << to_json(result.hierarchy_matrix_ms) << ",\n"
+        << "      \"paths_found\": " << result.paths_found << "\n"
+        << "    }";
+    return out.str();
+}
+
+// Parse the file into a builder, repeatedly, and keep the last graph
+Distribution measure_parse(const std::string &file_name, unsigned int repetitions, CSRGraph<double> &csr)
+{
+    std::vector<double> samples;
+    for (unsigned int i = 0; i < repetitions; i++)
+    {
+        auto begin = Clock::now();
+        GraphBuilder<double> builder;
+        parser::GraphFileReader<double> gf_reader(file_name, builder);
+        csr = builder.build();
+        samples.push_back(elapsed(begin, Clock::now(), 1e3));
+    }
+    return summarize(samples);
+}
+
+// Build the vertex and edge objects from elements, as the display path does
+Distribution measure_build(const CSRGraph<double> &csr, unsigned int repetitions)
+{
+    VertexElements vertices;
+    EdgeElements edges;
+    vertices.reserve(csr.get_num_vertices());
+    edges.reserve(csr.get_num_edges());
+    for (std::size_t index = 0; index < csr.get_num_vertices(); index++)
+    {
+        vertices.emplace_back(csr.get_position(index), csr.get_x(index), csr.get_y(index));
+        for (auto edge = csr.edges_begin(index); edge != csr.edges_end(index); edge++)
+            edges.emplace_back(csr.get_position(index), csr.get_position(csr.get_target(edge)), csr.get_cost(edge));
+    }
+
+    std::vector<double> samples;
+    for (unsigned int i = 0; i < repetitions; i++)
+    {
+        auto begin = Clock::now();
+        Graph<double> graph(vertices, edges);
+        samples.push_back(elapsed(begin, Clock::now(), 1e3));
+    }
+    return summarize(samples);
+}
+
+// Per-query latency of A* and Dijkstra on warm workspaces, the same random queries for both
+void measure_queries(const CSRGraph<double> &csr, unsigned int num_queries, GraphResult &result)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<std::size_t> index(0, csr.get_num_vertices() - 1);
+    std::vector<std::pair<unsigned int, unsigned int>> queries;
+    for (unsigned int i = 0; i < num_queries; i++)
+        queries.emplace_back(csr.get_position(index(rng)), csr.get_position(index(rng)));
+
+    SearchWorkspace<> workspace(csr.get_num_vertices());
+    find_astar_path(csr, queries[0].first, queries[0].second, workspace); // Warm up the workspace
+    find_dijkstra_path(csr, queries[0].first, queries[0].second, workspace);
+
+    std::vector<double> astar_samples, dijkstra_samples;
+    for (const auto &query : queries)
+    {
+        auto begin = Clock::now();
+        bool found = !find_astar_path(csr, query.first, query.second, workspace).empty();
+        astar_samples.push_back(elapsed(begin, Clock::now(), 1e6));
+        result.paths_found += found;
+    }
+    for (const auto &query : queries)
+    {
+        auto begin = Clock::now();
+        find_dijkstra_path(csr, query.first, query.second, workspace);
+        dijkstra_samples.push_back(elapsed(begin, Clock::now(), 1e6));
+    }
+    result.astar_us = summarize(astar_samples);
+    result.dijkstra_us = summarize(dijkstra_samples);
+}
+
+// Every entry must match a full Dijkstra from its source. The hierarchy adds its costs up over shortcuts,
+// so its entries may differ in the last bits.
+void check_matrix(const CSRGraph<double> &csr, const DistanceMatrix &matrix, double tolerance, const std::string &name)
+{
+    SearchWorkspace<> workspace(csr.get_num_vertices());
+    for (std::size_t row = 0; row < matrix.get_num_rows(); row++)
+    {
+        run_dijkstra(csr, matrix.sources[row], DijkstraQuery(), workspace);
+        for (std::size_t column = 0; column < matrix.get_num_columns(); column++)
+        {
+            double expected = workspace.get_cost(csr.get_index(matrix.targets[column]));
+            double cost = matrix.get_cost(row, column);
+            if (cost != expected && !(std::abs(cost - expected) <= tolerance * expected))
+                throw std::runtime_error(name + " distance matrix disagrees with Dijkstra from " + std::to_string(matrix.sources[row]) + " to " +
+                                         std::to_string(matrix.targets[column]));
+        }
+    }
+}
+
+// Many-to-many costs between random vertices with the Dijkstra kernel and, on smaller graphs, the
+// hierarchy kernel, each checked against single-source Dijkstra
+void measure_matrix(const CSRGraph<double> &csr, unsigned int repetitions, GraphResult &result)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> index(0, csr.get_num_vertices() - 1);
+    std::vector<unsigned int> sources, targets;
+    for (std::size_t i = 0; i < MATRIX_SIZE; i++)
+    {
+        sources.push_back(csr.get_position(index(rng)));
+        targets.push_back(csr.get_position(index(rng)));
+    }
+
+    parallel::ThreadPool pool;
+    DistanceMatrix matrix;
+    std::vector<double> samples;
+    for (unsigned int i = 0; i < repetitions; i++)
+    {
+        auto begin = Clock::now();
+        matrix = distance_matrix(csr, sources, targets, pool);
+        samples.push_back(elapsed(begin, Clock::now(), 1e3));
+    }
+    check_matrix(csr, matrix, 0, "Dijkstra");
+    result.matrix_ms = summarize(samples);
+
+    if (csr.get_num_vertices() > MAX_HIERARCHY_VERTICES)
+        return;
+    ContractionHierarchy<double> hierarchy(csr);
+    samples.clear();
+    for (unsigned int i = 0; i < repetitions; i++)
+    {
+        auto begin = Clock::now();
+        matrix = distance_matrix(csr, hierarchy, sources, targets, pool);
+        samples.push_back(elapsed(begin, Clock::now(), 1e3));
+    }
+    check_matrix(csr, matrix, 1e-9, "Contraction hierarchy");
+    result.hierarchy_matrix_ms = summarize(samples);
+}
+
+GraphResult run_file(const std::string &file_name, const std::string &source, const BenchOptions &options)
+{
+    std::cerr << "Benchmarking " << file_name << std::endl;
+    GraphResult result;
+    result.name = file_name;
+    result.source = source;
+    CSRGraph<double> csr;
+    result.parse_ms = measure_parse(file_name, options.repetitions, csr);
+    result.num_vertices = csr.get_num_vertices();
+    result.num_edges = csr.get_num_edges();
+    result.build_ms = measure_build(csr, options.repetitions);
+    if (!csr.is_empty())
+    {
+        measure_queries(csr, options.num_queries, result);
+        measure_matrix(csr, options.repetitions, result);
+    }
+    return result;
+}
+
+// Synthetic graphs go through a temporary text file so that parsing is measured on them too
+GraphResult run_synthetic(const std::string &model_name, const generator::RandomGraphOptions &graph_options, const BenchOptions &options)
+{
+    auto graph = generator::generate_random_graph<double>(graph_options);
+    std::string name = model_name + "_" + std::to_string(graph.vertices.size()) + "v_" + std::to_string(graph.edges.size()) + "e";
+    auto file_name = (std::filesystem::temp_directory_path() / ("pathfinder_bench_" + name + ".txt")).string();
+    generator::write_random_graph(graph, file_name, generator::GraphFormat::TEXT);
+    try
+    {
+        GraphResult result = run_file(file_name, "synthetic", options);
+        result.name = name;
+        std::filesystem::remove(file_name);
+        return result;
+    }
+    catch (...)
+    {
+        std::filesystem::remove(file_name);
+        throw;
+    }
+}
+
+BenchOptions parse_options(int argc, char **argv)
+{
+    BenchOptions options;
+    int option;
+    while ((option = getopt(argc, argv, "o:q:r:n")) != -1)
+    {
+        switch (option)
+        {
+        case 'o':
+            options.output_file = optarg;
+            break;
+        case 'q':
+            options.num_queries = std::stoul(optarg);
+            break;
+        case 'r':
+            options.repetitions = std::stoul(optarg);
+            break;
+        case 'n':
+            options.synthetic = false;
+            break;
+        default:
+            throw std::invalid_argument("Usage: pathfinder_bench [-o results.json] [-q queries] [-r repetitions] [-n] [graph files...]");
+        }
+    }
+    if (options.num_queries == 0 || options.repetitions == 0)
+        throw std::invalid_argument("The query count and the repetition count must be positive.");
+    for (int i = optind; i < argc; i++)
+        options.input_files.push_back(argv[i]);
+
+    // Without explicit files, every bundled input is measured
+    if (options.input_files.empty() && std::filesystem::is_directory("inputs"))
+    {
+        for (const auto &entry : std::filesystem::directory_iterator("inputs"))
+        {
+            if (entry.path().extension() == ".txt")
+                options.input_files.push_back(entry.path().string());
+        }
+        std::sort(options.input_files.begin(), options.input_files.end());
+    }
+    return options;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        BenchOptions options = parse_options(argc, argv);
+
+        std::vector<GraphResult> results;
+        for (const auto &file_name : options.input_files)
+            results.push_back(run_file(file_name, "file", options));
+        if (options.synthetic)
+        {
+            for (unsigned int scale : {10000u, 100000u})
+            {
+                generator::RandomGraphOptions graph_options;
+                graph_options.num_vertices = scale;
+                graph_options.num_edges = scale * 5;
+                graph_options.max_bound = 10000;
+                graph_options.max_cost = 100;
+                graph_options.seed = scale;
+                results.push_back(run_synthetic("random", graph_options, options));
+            }
+
+            // Road-like graph, where A* has an admissible heuristic to work with
+            generator::RandomGraphOptions graph_options;
+            graph_options.model = generator::GraphModel::GRID;
+            graph_options.num_vertices = 100000;
+            graph_options.max_bound = 10000;
+            results.push_back(run_synthetic("grid", graph_options, options));
+        }
+
+        std::ostringstream json;
+        json << "{\n"
+             << "  \"benchmark\": \"pathfinder_bench\",\n"
+             << "  \"queries\": " << options.num_queries << ",\n"
+             << "  \"repetitions\": " << options.repetitions << ",\n"
+             << "  \"graphs\": [\n";
+        for (std::size_t i = 0; i < results.size(); i++)
+            json << to_json(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+        json << "  ]\n"
+             << "}\n";
+
+        if (options.output_file.empty())
+            std::cout << json.str();
+        else
+        {
+            std::ofstream file(options.output_file);
+            if (!(file << json.str()))
+                throw std::runtime_error("Error writing file: " + options.output_file);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <stdexcept>
+#include "../include/graph/csr_graph.hpp"
+#include "../include/parser/reader.hpp"
+#include "../include/algorithm/queue.hpp"
+#include "../include/algorithm/workspace.hpp"
+#include "../include/algorithm/astar.hpp"
+#include "../include/algorithm/dijkstra.hpp"
+
+using namespace graph;
+using namespace algorithm;
+
+using VertexElements = CSRGraph<double>::VertexElements;
+using EdgeElements = CSRGraph<double>::EdgeElements;
+
+// Build a random graph with integer costs so that every queue policy, including the radix heap, is exact
+CSRGraph<double> generate_graph(unsigned int num_vertices, unsigned int num_edges, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::uniform_int_distribution<unsigned int> vertex(0, num_vertices - 1);
+    std::uniform_int_distribution<int> cost(1, 100);
+
+    VertexElements vertices;
+    EdgeElements edges;
+    for (unsigned int i = 0; i < num_vertices; i++)
+        vertices.emplace_back(i, coordinate(rng), coordinate(rng));
+    while (edges.size() < num_edges)
+    {
+        unsigned int src = vertex(rng), dest = vertex(rng);
+        if (src != dest)
+            edges.emplace_back(src, dest, cost(rng));
+    }
+    return CSRGraph<double>(vertices, edges);
+}
+
+// Run the same queries with the given queue policy and report the mean query time in microseconds
+template <class Queue>
+void run_queries(const std::string &name, const CSRGraph<double> &csr, const std::vector<std::pair<unsigned int, unsigned int>> &queries)
+{
+    SearchWorkspace<Queue> workspace(csr.get_num_vertices());
+    std::size_t path_vertices = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (const auto &query : queries)
+        path_vertices += find_dijkstra_path(csr, query.first, query.second, workspace).size();
+    auto dijkstra_end = std::chrono::steady_clock::now();
+    for (const auto &query : queries)
+        path_vertices += find_astar_path(csr, query.first, query.second, workspace).size();
+    auto astar_end = std::chrono::steady_clock::now();
+
+    double dijkstra_us = std::chrono::duration<double, std::micro>(dijkstra_end - begin).count() / queries.size();
+    double astar_us = std::chrono::duration<double, std::micro>(astar_end - dijkstra_end).count() / queries.size();
+    std::cout << "  " << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(14) << dijkstra_us << std::setw(14) << astar_us
+              << std::setw(12) << path_vertices << std::endl;
+}
+
+void run_benchmark(const std::string &title, const CSRGraph<double> &csr, unsigned int num_queries)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<unsigned int> index(0, csr.get_num_vertices() - 1);
+    std::vector<std::pair<unsigned int, unsigned int>> queries;
+    for (unsigned int i = 0; i < num_queries; i++)
+        queries.emplace_back(csr.get_position(index(rng)), csr.get_position(index(rng)));
+
+    std::cout << title << " (" << csr.get_num_vertices() << " vertices, " << csr.get_num_edges() << " edges, "
+              << num_queries << " queries)" << std::endl;
+    std::cout << "  " << std::left << std::setw(14) << "queue" << std::right << std::setw(14) << "dijkstra us"
+              << std::setw(14) << "astar us" << std::setw(12) << "checksum" << std::endl;
+    run_queries<DaryHeap<2>>("binary heap", csr, queries);
+    run_queries<DaryHeap<4>>("4-ary heap", csr, queries);
+    run_queries<PairingHeap>("pairing heap", csr, queries);
+    run_queries<RadixHeap>("radix heap", csr, queries);
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::string input_file = argc > 1 ? argv[1] : "inputs/400V1400E.txt";
+        GraphBuilder<double> builder;
+        parser::GraphFileReader<double> gf_reader(input_file, builder);
+        run_benchmark(input_file, builder.build(), 1000);
+
+        run_benchmark("random", generate_graph(10000, 50000, 1), 200);
+        run_benchmark("random", generate_graph(100000, 500000, 2), 50);
+        run_benchmark("random", generate_graph(1000000, 5000000, 3), 10);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,77 +1,131 @@
-#include "../include/parser/reader.hpp"
-#include "../include/parser/writer.hpp"
-#include <stdlib.h>
 #include <iostream>
-
-using namespace parser;
-
-int main(int argc, char** argv) {
-    using EdgeInfo = std::tuple<unsigned int, unsigned int, double>;
-    using VertexInfo = std::tuple<unsigned int, float, float>;
-
-    if (argc < 2)
-        throw std::invalid_argument("Error: File path to write to is required.");
-
-    GraphFileWriter<float> gfw(argv[1]);
-
-    std::vector<EdgeInfo> edges;
-    std::vector<VertexInfo> vertices;
-
-    int start, end;
-    int num_vertices, num_edges;
-    int max_bound;
-    int cost = 10;
-
-    // Get num_vertices
-    std::cout << "Enter the number of vertices: ";
-    if (!(std::cin >> num_vertices)) {
-        std::cerr << "Invalid input for num_vertices." << std::endl;
-        return 1;
-    }
-
-    // Get num_edges
-    std::cout << "Enter the number of edges: ";
-    if (!(std::cin >> num_edges)) {
-        std::cerr << "Invalid input for num_edges." << std::endl;
-        return 1;
+#include <string>
+#include <chrono>
+#include <thread>
+#include <getopt.h>
+#include "../include/generator/random_graph.hpp"
+#include "../include/generator/graph_output.hpp"
+
+using namespace generator;
+
+void print_usage(const char *program)
+{
+    std::cerr << "Usage: " << program << " -o <output graph> -n <vertices> [options]" << std::endl;
+    std::cerr << "  -o  Graph file to write" << std::endl;
+    std::cerr << "  -m  Model: uniform, grid, knn or delaunay. Default: uniform" << std::endl;
+    std::cerr << "  -n  Number of vertices" << std::endl;
+    std::cerr << "  -e  Number of edges, uniform model only" << std::endl;
+    std::cerr << "  -k  Neighbours per vertex, knn model only. Default: 4" << std::endl;
+    std::cerr << "  -r  Fraction of streets left out, grid model only. Default: 0.1" << std::endl;
+    std::cerr << "  -d  Largest detour factor of the geometric models' costs. Default: 1.5" << std::endl;
+    std::cerr << "  -b  Max bound for x and y. Default: 1000" << std::endl;
+    std::cerr << "  -c  Costs of the uniform model are below this. Default: 10" << std::endl;
+    std::cerr << "  -S  Start vertex. Default: 0" << std::endl;
+    std::cerr << "  -E  End vertex. Default: the last vertex" << std::endl;
+    std::cerr << "  -s  Random seed. Default: 1" << std::endl;
+    std::cerr << "  -t  Worker threads. Default: all cores" << std::endl;
+    std::cerr << "  -f  Output format: text or snapshot. Default: text" << std::endl;
+}
+
+GraphModel parse_model(const std::string &name)
+{
+    if (name == "uniform")
+        return GraphModel::UNIFORM;
+    if (name == "grid")
+        return GraphModel::GRID;
+    if (name == "knn")
+        return GraphModel::KNN;
+    if (name == "delaunay")
+        return GraphModel::DELAUNAY;
+    throw std::invalid_argument("Invalid model: " + name + ". Use 'uniform', 'grid', 'knn' or 'delaunay'.");
+}
+
+// Generates a reproducible synthetic graph, the same options and seed always give the same file
+int main(int argc, char **argv)
+{
+    try
+    {
+        RandomGraphOptions options;
+        std::string output_file;
+        GraphFormat format = GraphFormat::TEXT;
+        unsigned int num_threads = 0;
+        bool has_end = false;
+
+        int option;
+        while ((option = getopt(argc, argv, "o:m:n:e:k:r:d:b:c:S:E:s:t:f:h")) != -1)
+        {
+            switch (option)
+            {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'm':
+                options.model = parse_model(optarg);
+                break;
+            case 'n':
+                options.num_vertices = std::stoul(optarg);
+                break;
+            case 'e':
+                options.num_edges = std::stoul(optarg);
+                break;
+            case 'k':
+                options.k = std::stoul(optarg);
+                break;
+            case 'r':
+                options.removed_streets = std::stod(optarg);
+                break;
+            case 'd':
+                options.max_detour = std::stod(optarg);
+                break;
+            case 'b':
+                options.max_bound = std::stoul(optarg);
+                break;
+            case 'c':
+                options.max_cost = std::stoul(optarg);
+                break;
+            case 'S':
+                options.start = std::stoul(optarg);
+                break;
+            case 'E':
+                options.end = std::stoul(optarg);
+                has_end = true;
+                break;
+            case 's':
+                options.seed = std::stoul(optarg);
+                break;
+            case 't':
+                num_threads = std::stoul(optarg);
+                break;
+            case 'f':
+                if (std::string(optarg) != "text" && std::string(optarg) != "snapshot")
+                    throw std::invalid_argument("Invalid format. Use 'text' or 'snapshot'.");
+                format = std::string(optarg) == "text" ? GraphFormat::TEXT : GraphFormat::SNAPSHOT;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        if (output_file.empty() || options.num_vertices == 0)
+        {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (!has_end)
+            options.end = options.num_vertices - 1;
+
+        auto begin = std::chrono::steady_clock::now();
+        parallel::ThreadPool pool(num_threads ? num_threads : std::thread::hardware_concurrency());
+        auto graph = generate_random_graph<double>(options, &pool);
+        write_random_graph(graph, output_file, format, &pool);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << "Wrote " << graph.vertices.size() << " vertices and " << graph.edges.size() << " edges to "
+                  << output_file << " in " << elapsed << " s" << std::endl;
     }
-
-    // Get max_bound
-    std::cout << "Enter the max bound for x and y: ";
-    if (!(std::cin >> max_bound)) {
-        std::cerr << "Invalid input for max_bound." << std::endl;
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
-
-    // Get start vertex
-    std::cout << "Enter the start vertex: ";
-    if (!(std::cin >> start || start < 0)) {
-        std::cerr << "Invalid input for start." << std::endl;
-        return 1;
-    }
-
-    // Get end vertex
-    std::cout << "Enter the end vertex: ";
-    if (!(std::cin >> end || end > num_vertices)) {
-        std::cerr << "Invalid input for end." << std::endl;
-        return 1;
-    }
-
-    auto start_end = std::make_tuple<unsigned int>(start, end);
-
-    for (int i = 0; i < num_vertices; i++) {
-        vertices.emplace_back(i, 1 + (rand() % max_bound), 1 + (rand() % max_bound));
-    }
-
-    for (int i = 0; i < num_edges; i++) {
-        auto v1 = std::get<0>(vertices[(rand() % num_vertices)]);
-        auto v2 = std::get<0>(vertices[(rand() % num_vertices)]);
-        edges.emplace_back(v1, v2, (rand() % cost));
-    }
-
-    gfw.write_start_end(start_end);
-    gfw.write_vertices(vertices);
-    gfw.write_edges(edges, "");
-
     return 0;
-}
\ No newline at end of file
+}
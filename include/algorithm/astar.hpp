@@ -1,87 +1,184 @@
 #ifndef ASTAR_H
 #define ASTAR_H
 
-#include <queue>
+#include <stdexcept>
 #include "../graph/graph.hpp"
+#include "workspace.hpp"
+#include "heuristic.hpp"
+#include "path.hpp"
 
 using namespace graph;
 
 namespace algorithm
 {
-    std::vector<unsigned int> reconstruct_astar_path(const std::unordered_map<unsigned int, unsigned int> &came_from, unsigned int current_position);
-
-    template <class T>
-    void compute_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position)
+    // Edge costs are read from costs, anything with get_cost(edge): the graph itself or a pinned
+    // CostSnapshot of dynamic costs. An instrumented workspace gets the query's stats reported.
+    template <class T, class Queue, class Heuristic, class Costs>
+    std::vector<unsigned int> find_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, SearchWorkspace<Queue> &workspace,
+                                              const Heuristic &heuristic, const Costs &costs)
     {
-        // Initialize data structures for A* algorithm
-        using DistPos = std::pair<double, unsigned int>;
-        std::unordered_map<unsigned int, double> g_score;         // Cost from start to each vertex
-        std::unordered_map<unsigned int, double> f_score;         // Estimated total cost from start to goal through each vertex
-        std::unordered_map<unsigned int, unsigned int> came_from; // Previous vertex in the optimal path
-        std::priority_queue<DistPos, std::vector<DistPos>, std::greater<DistPos>> open_set;
-
-        // Initialize scores to infinity for all vertices except the start vertex
-        for (const auto &vertex_entry : graph.get_vertices())
+        // The workspace holds the cost from start (g score) and the previous vertex for each index
+        using Index = typename CSRGraph<T>::Index;
+        PhaseTimer timer;
+        const Index start_index = csr.get_index(start_position);
+        const Index goal_index = csr.get_index(goal_position);
+        workspace.resize(csr.get_num_vertices());
+        workspace.reset();
+        auto &open_set = workspace.get_queue();
+        const bool instrumented = workspace.is_instrumented();
+        auto &stats = workspace.get_stats();
+
+        // Only the start vertex is labelled, every other vertex is implicitly at infinity
+        workspace.set_label(start_index, 0, CSRGraph<T>::INVALID_INDEX);
+        open_set.push(start_index, heuristic.estimate(start_index, goal_index));
+        if (instrumented)
         {
-            unsigned int vertex_position = vertex_entry.first;
-            g_score[vertex_position] = (vertex_position == start_position) ? 0 : std::numeric_limits<double>::infinity();
-            f_score[vertex_position] = (vertex_position == start_position) ? graph.get_heuristic(start_position, goal_position) : std::numeric_limits<double>::infinity();
-            open_set.push(std::make_pair(f_score[vertex_position], vertex_position));
+            stats = SearchStats();
+            stats.algorithm = "astar";
+            stats.start_position = start_position;
+            stats.end_position = goal_position;
+            stats.queue_pushes = stats.peak_queue_size = stats.heuristic_calls = 1;
+            stats.init_ms = timer.lap();
         }
 
+        // Neighbors without a cached estimate, evaluated in one batch per expanded vertex
+        auto &pending = workspace.get_index_scratch();
+        auto &pending_estimates = workspace.get_cost_scratch();
+
         // A* algorithm
+        bool found = false;
         while (!open_set.empty())
         {
-            unsigned int current_position = open_set.top().second;
-            open_set.pop();
+            Index current_index = open_set.pop();
+            if (instrumented)
+                stats.settled_vertices++;
 
-            if (current_position == goal_position)
+            if (current_index == goal_index)
             {
-                auto optimal_path = reconstruct_astar_path(came_from, current_position);
-                if (!optimal_path.empty())
-                    optimal_path.insert(optimal_path.begin(), start_position);
-                graph.set_astar_path(optimal_path);
-                return;
+                found = true;
+                break;
             }
 
-            const auto current_vertex = graph.get_vertex(current_position); // Use your method to get the vertex
+            const auto edges_begin = csr.edges_begin(current_index);
+            const auto edges_end = csr.edges_end(current_index);
+            pending.clear();
+            for (auto edge = edges_begin; edge != edges_end; edge++)
+            {
+                if (!workspace.has_estimate(csr.get_target(edge)))
+                    pending.push_back(csr.get_target(edge));
+            }
+            pending_estimates.resize(pending.size());
+            estimate_batch(heuristic, pending.data(), pending.size(), goal_index, pending_estimates.data());
+            if (instrumented)
+                stats.heuristic_calls += pending.size();
+            for (std::size_t i = 0; i < pending.size(); i++)
+                workspace.set_estimate(pending[i], pending_estimates[i]);
 
-            for (const auto &edge : current_vertex->get_edges())
+            double current_g_score = workspace.get_cost(current_index);
+            for (auto edge = edges_begin; edge != edges_end; edge++)
             {
-                unsigned int neighbor_position = edge->get_destination()->get_position();
-                double edge_weight = edge->get_cost();
+                Index neighbor_index = csr.get_target(edge);
+                double edge_weight = costs.get_cost(edge);
 
                 if (edge_weight == -1)
                     continue; // Skip untraversable edges
 
-                double tentative_g_score = g_score[current_position] + edge_weight;
+                double tentative_g_score = current_g_score + edge_weight;
+                if (instrumented)
+                    stats.relaxed_edges++;
 
-                if (tentative_g_score < g_score[neighbor_position])
+                if (tentative_g_score < workspace.get_cost(neighbor_index))
                 {
-                    came_from[neighbor_position] = current_position;
-                    g_score[neighbor_position] = tentative_g_score;
-                    f_score[neighbor_position] = g_score[neighbor_position] + graph.get_heuristic(neighbor_position, goal_position);
+                    // An infinite estimate proves the goal unreachable from the neighbor
+                    double h_score = workspace.get_estimate(neighbor_index);
+                    if (h_score == std::numeric_limits<double>::infinity())
+                        continue;
+                    workspace.set_label(neighbor_index, tentative_g_score, current_index);
 
-                    // Update the priority queue with the new f_score
-                    open_set.push(std::make_pair(f_score[neighbor_position], neighbor_position));
+                    // Insert the neighbor or decrease its f_score in place
+                    double f_score = tentative_g_score + h_score;
+                    if (instrumented)
+                    {
+                        stats.queue_pushes++;
+                        stats.decrease_keys += open_set.contains(neighbor_index);
+                    }
+                    open_set.push(neighbor_index, f_score);
+                    if (instrumented)
+                        stats.peak_queue_size = std::max(stats.peak_queue_size, open_set.size());
                 }
             }
         }
-        // No path found
-        graph.set_astar_path(std::vector<unsigned int>());
-    }
+        if (instrumented)
+            stats.search_ms = timer.lap();
 
-    std::vector<unsigned int> reconstruct_astar_path(const std::unordered_map<unsigned int, unsigned int> &came_from, unsigned int current_position)
-    {
+        // An empty path when the goal was not reached
         std::vector<unsigned int> path;
-        while (came_from.find(current_position) != came_from.end())
+        if (found)
+            path = reconstruct_path(csr, workspace, start_index, goal_index);
+        if (instrumented)
         {
-            path.push_back(current_position);
-            current_position = came_from.at(current_position);
+            stats.path_found = !path.empty();
+            stats.path_ms = timer.lap();
+            workspace.report_stats();
         }
-        std::reverse(path.begin(), path.end());
         return path;
     }
+
+    template <class T, class Queue, class Heuristic>
+    std::vector<unsigned int> find_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, SearchWorkspace<Queue> &workspace,
+                                              const Heuristic &heuristic)
+    {
+        return find_astar_path(csr, start_position, goal_position, workspace, heuristic, csr);
+    }
+
+    template <class T, class Queue>
+    std::vector<unsigned int> find_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, SearchWorkspace<Queue> &workspace)
+    {
+        return find_astar_path(csr, start_position, goal_position, workspace, EuclideanHeuristic<T>(csr));
+    }
+
+    template <class Queue = QuadHeap, class T>
+    std::vector<unsigned int> find_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position)
+    {
+        SearchWorkspace<Queue> workspace(csr.get_num_vertices());
+        return find_astar_path(csr, start_position, goal_position, workspace);
+    }
+
+    template <class Queue = QuadHeap, class T>
+    void compute_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position)
+    {
+        SearchWorkspace<Queue> workspace;
+        compute_astar(graph, start_position, goal_position, workspace);
+    }
+
+    template <class T, class Queue>
+    void compute_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position, SearchWorkspace<Queue> &workspace)
+    {
+        compute_astar(graph, start_position, goal_position, workspace, EuclideanHeuristic<T>(graph.get_csr()));
+    }
+
+    template <class T, class Queue, class Heuristic>
+    void compute_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position, SearchWorkspace<Queue> &workspace, const Heuristic &heuristic)
+    {
+        if (is_landmark_heuristic<Heuristic> && graph.get_dynamic_costs())
+            throw std::runtime_error("Landmark heuristics do not support dynamic edge costs");
+
+        // Pairs the cached components prove unreachable are answered without a search
+        if (!graph.may_reach(start_position, goal_position))
+        {
+            if (workspace.is_instrumented())
+            {
+                workspace.get_stats() = SearchStats{"astar", start_position, goal_position};
+                workspace.report_stats();
+            }
+            graph.set_astar_path(std::vector<unsigned int>());
+            return;
+        }
+
+        // One cost version is pinned for the whole query when the graph has dynamic costs
+        graph.set_astar_path(graph.with_costs([&](const auto &costs)
+                                              { return find_astar_path(graph.get_csr(), start_position, goal_position, workspace, heuristic, costs); }));
+    }
 } // namespace algorithm
 
 #endif // ASTAR_H
@@ -0,0 +1,197 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <vector>
+#include <tuple>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include "../graph/csr_graph.hpp"
+#include "../graph/connectivity.hpp"
+#include "../parallel/thread_pool.hpp"
+#include "path.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Answer of one query of a batch. The cost is 0 when start and end coincide and infinity when
+    // the end cannot be reached.
+    struct BatchResult
+    {
+        unsigned int start_position;
+        unsigned int end_position;
+        double cost;
+        std::vector<unsigned int> path;
+    };
+
+    // Solves many independent (start, end) queries on a thread pool over a shared read-only CSR graph.
+    // Queries are handed out in chunks, every worker owns its search state, and the results are passed
+    // to the sink on the calling thread in query order. At most a few chunks per worker are kept
+    // ahead of the sink, so memory stays bounded however long the batch is.
+    template <class T>
+    class BatchQueryEngine
+    {
+    public:
+        using Query = std::tuple<unsigned int, unsigned int>;
+
+        BatchQueryEngine(const CSRGraph<T> &csr, parallel::ThreadPool &pool, std::size_t chunk_size = 256);
+
+        // make_solver() is called once per worker and returns a callable
+        //   solver(start_position, end_position) -> path as vertex positions
+        // owning its own workspace. sink(const BatchResult &) receives the results in query order.
+        template <class SolverFactory, class Sink>
+        void run(const std::vector<Query> &queries, SolverFactory make_solver, Sink sink);
+
+        // Answer the pairs these components prove unreachable without calling the solver. The
+        // components must belong to the same CSR and outlive the runs.
+        void set_connectivity(const Connectivity<T> *connectivity);
+
+    private:
+        const CSRGraph<T> &csr;
+        parallel::ThreadPool &pool;
+        std::size_t chunk_size;
+        const Connectivity<T> *connectivity = nullptr;
+    };
+
+    template <class T>
+    inline BatchQueryEngine<T>::BatchQueryEngine(const CSRGraph<T> &csr, parallel::ThreadPool &pool, std::size_t chunk_size)
+        : csr(csr), pool(pool), chunk_size(std::max<std::size_t>(chunk_size, 1)) {}
+
+    template <class T>
+    inline void BatchQueryEngine<T>::set_connectivity(const Connectivity<T> *connectivity)
+    {
+        this->connectivity = connectivity;
+    }
+
+    template <class T>
+    template <class SolverFactory, class Sink>
+    inline void BatchQueryEngine<T>::run(const std::vector<Query> &queries, SolverFactory make_solver, Sink sink)
+    {
+        // Reject unknown vertices up front rather than from inside a worker
+        for (std::size_t i = 0; i < queries.size(); i++)
+        {
+            if (csr.find_index(std::get<0>(queries[i])) == CSRGraph<T>::INVALID_INDEX ||
+                csr.find_index(std::get<1>(queries[i])) == CSRGraph<T>::INVALID_INDEX)
+                throw std::out_of_range("Query " + std::to_string(i + 1) + ": vertex position not found");
+        }
+
+        const std::size_t num_chunks = (queries.size() + chunk_size - 1) / chunk_size;
+        const std::size_t window = 4 * pool.get_num_threads();
+
+        // Ring of finished chunks waiting for the sink, chunk c lives in slot c % window
+        std::vector<std::vector<BatchResult>> slots(window);
+        std::vector<bool> ready(window, false);
+        std::size_t next_chunk = 0;
+        std::size_t emitted_chunks = 0;
+        bool aborted = false;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable chunk_ready;
+        std::condition_variable slot_free;
+
+        auto abort = [&](std::exception_ptr exception)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = exception;
+                aborted = true;
+            }
+            chunk_ready.notify_all();
+            slot_free.notify_all();
+        };
+
+        auto worker = [&]()
+        {
+            try
+            {
+                auto solver = make_solver();
+                while (true)
+                {
+                    std::size_t chunk;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        slot_free.wait(lock, [&]()
+                                       { return aborted || next_chunk >= num_chunks || next_chunk < emitted_chunks + window; });
+                        if (aborted || next_chunk >= num_chunks)
+                            return;
+                        chunk = next_chunk++;
+                    }
+
+                    const std::size_t first = chunk * chunk_size;
+                    const std::size_t last = std::min(first + chunk_size, queries.size());
+                    std::vector<BatchResult> results;
+                    results.reserve(last - first);
+                    for (std::size_t i = first; i < last; i++)
+                    {
+                        unsigned int start_position, end_position;
+                        std::tie(start_position, end_position) = queries[i];
+                        BatchResult result{start_position, end_position, 0, {}};
+                        if (connectivity && !connectivity->may_reach(csr.get_index(start_position), csr.get_index(end_position)))
+                        {
+                            result.cost = std::numeric_limits<double>::infinity();
+                            results.push_back(std::move(result));
+                            continue;
+                        }
+                        result.path = solver(start_position, end_position);
+                        if (start_position != end_position)
+                            result.cost = result.path.empty() ? std::numeric_limits<double>::infinity() : path_cost(csr, result.path);
+                        results.push_back(std::move(result));
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        slots[chunk % window] = std::move(results);
+                        ready[chunk % window] = true;
+                    }
+                    chunk_ready.notify_all();
+                }
+            }
+            catch (...)
+            {
+                abort(std::current_exception());
+            }
+        };
+
+        for (unsigned int i = 0; i < pool.get_num_threads(); i++)
+            pool.submit(worker);
+
+        // Hand the chunks to the sink in order as they complete
+        try
+        {
+            for (std::size_t chunk = 0; chunk < num_chunks; chunk++)
+            {
+                std::vector<BatchResult> results;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    chunk_ready.wait(lock, [&]()
+                                     { return aborted || ready[chunk % window]; });
+                    if (aborted)
+                        break;
+                    results = std::move(slots[chunk % window]);
+                    ready[chunk % window] = false;
+                    emitted_chunks++;
+                }
+                slot_free.notify_all();
+                for (const auto &result : results)
+                    sink(result);
+            }
+        }
+        catch (...)
+        {
+            abort(std::current_exception());
+        }
+
+        // The workers refer to this frame, wait for them before leaving
+        pool.wait();
+        if (error)
+            std::rethrow_exception(error);
+    }
+} // namespace algorithm
+
+#endif // BATCH_H
@@ -0,0 +1,228 @@
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+
+#include <stdexcept>
+#include "../graph/graph.hpp"
+#include "workspace.hpp"
+#include "heuristic.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Search state for both frontiers of a bidirectional query
+    template <class Queue = QuadHeap>
+    struct BidirectionalWorkspace
+    {
+        SearchWorkspace<Queue> forward;
+        SearchWorkspace<Queue> backward;
+    };
+
+    // Grow a forward frontier from the start over outgoing edges and a backward frontier from the goal
+    // over incoming edges. Forward keys are d_f(v) + p(v) and backward keys d_b(v) - p(v), so with a
+    // potential p the two searches stay consistent with each other and the search may stop as soon as
+    // the two smallest keys add up to the best meeting cost found so far. Edge costs are read from
+    // costs, anything with get_cost(edge): the graph itself or a pinned CostSnapshot of dynamic costs.
+    template <class T, class Queue, class Potential, class Costs>
+    std::vector<unsigned int> find_bidirectional_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position,
+                                                      BidirectionalWorkspace<Queue> &workspace, Potential potential, const Costs &costs)
+    {
+        using Index = typename CSRGraph<T>::Index;
+        const Index start_index = csr.get_index(start_position);
+        const Index goal_index = csr.get_index(goal_position);
+        if (start_index == goal_index)
+            return std::vector<unsigned int>();
+
+        auto &forward = workspace.forward;
+        auto &backward = workspace.backward;
+        forward.resize(csr.get_num_vertices());
+        backward.resize(csr.get_num_vertices());
+        forward.reset();
+        backward.reset();
+        auto &forward_queue = forward.get_queue();
+        auto &backward_queue = backward.get_queue();
+
+        forward.set_label(start_index, 0, CSRGraph<T>::INVALID_INDEX);
+        forward_queue.push(start_index, potential(start_index));
+        backward.set_label(goal_index, 0, CSRGraph<T>::INVALID_INDEX);
+        backward_queue.push(goal_index, -potential(goal_index));
+
+        double best_cost = std::numeric_limits<double>::infinity();
+        Index meeting_index = CSRGraph<T>::INVALID_INDEX;
+
+        while (!forward_queue.empty() && !backward_queue.empty())
+        {
+            if (forward_queue.top_key() + backward_queue.top_key() >= best_cost)
+                break;
+
+            // Expand the side with the smaller frontier
+            if (forward_queue.size() <= backward_queue.size())
+            {
+                Index current_index = forward_queue.pop();
+                double current_cost = forward.get_cost(current_index);
+                for (auto edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+                {
+                    double cost = costs.get_cost(edge);
+                    if (cost == -1)
+                        continue; // Skip untraversable edges
+
+                    Index neighbor_index = csr.get_target(edge);
+                    double total_cost = current_cost + cost;
+                    if (total_cost < forward.get_cost(neighbor_index))
+                    {
+                        // A key that is not finite means the potential proves the vertex off every start-goal path
+                        double key = total_cost + potential(neighbor_index);
+                        if (!(key < std::numeric_limits<double>::infinity()))
+                            continue;
+                        forward.set_label(neighbor_index, total_cost, current_index);
+                        forward_queue.push(neighbor_index, key);
+                        if (backward.is_reached(neighbor_index) && total_cost + backward.get_cost(neighbor_index) < best_cost)
+                        {
+                            best_cost = total_cost + backward.get_cost(neighbor_index);
+                            meeting_index = neighbor_index;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                Index current_index = backward_queue.pop();
+                double current_cost = backward.get_cost(current_index);
+                for (auto in_edge = csr.in_edges_begin(current_index); in_edge != csr.in_edges_end(current_index); in_edge++)
+                {
+                    double cost = costs.get_cost(csr.get_forward_edge(in_edge));
+                    if (cost == -1)
+                        continue; // Skip untraversable edges
+
+                    Index neighbor_index = csr.get_source(in_edge);
+                    double total_cost = current_cost + cost;
+                    if (total_cost < backward.get_cost(neighbor_index))
+                    {
+                        double key = total_cost - potential(neighbor_index);
+                        if (!(key < std::numeric_limits<double>::infinity()))
+                            continue;
+                        backward.set_label(neighbor_index, total_cost, current_index);
+                        backward_queue.push(neighbor_index, key);
+                        if (forward.is_reached(neighbor_index) && total_cost + forward.get_cost(neighbor_index) < best_cost)
+                        {
+                            best_cost = total_cost + forward.get_cost(neighbor_index);
+                            meeting_index = neighbor_index;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Join the forward path start -> meeting vertex with the backward path meeting vertex -> goal
+        std::vector<unsigned int> path;
+        if (meeting_index == CSRGraph<T>::INVALID_INDEX)
+            return path;
+        for (Index index = meeting_index; index != CSRGraph<T>::INVALID_INDEX; index = forward.get_previous(index))
+            path.push_back(csr.get_position(index));
+        std::reverse(path.begin(), path.end());
+        for (Index index = backward.get_previous(meeting_index); index != CSRGraph<T>::INVALID_INDEX; index = backward.get_previous(index))
+            path.push_back(csr.get_position(index));
+        return path;
+    }
+
+    template <class T, class Queue, class Potential>
+    std::vector<unsigned int> find_bidirectional_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position,
+                                                      BidirectionalWorkspace<Queue> &workspace, Potential potential)
+    {
+        return find_bidirectional_path(csr, start_position, goal_position, workspace, potential, csr);
+    }
+
+    template <class T, class Queue, class Costs>
+    std::vector<unsigned int> find_bidirectional_dijkstra_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace,
+                                                               const Costs &costs)
+    {
+        auto zero_potential = [](typename CSRGraph<T>::Index)
+        { return 0.0; };
+        return find_bidirectional_path(csr, start_position, goal_position, workspace, zero_potential, costs);
+    }
+
+    template <class T, class Queue>
+    std::vector<unsigned int> find_bidirectional_dijkstra_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace)
+    {
+        return find_bidirectional_dijkstra_path(csr, start_position, goal_position, workspace, csr);
+    }
+
+    template <class T, class Queue, class Heuristic, class Costs>
+    std::vector<unsigned int> find_bidirectional_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace,
+                                                            const Heuristic &heuristic, const Costs &costs)
+    {
+        // Average of the forward estimate to the goal and the backward estimate to the start
+        const auto start_index = csr.get_index(start_position);
+        const auto goal_index = csr.get_index(goal_position);
+        auto average_potential = [&](typename CSRGraph<T>::Index index)
+        { return (heuristic.estimate(index, goal_index) - heuristic.estimate(start_index, index)) / 2; };
+        return find_bidirectional_path(csr, start_position, goal_position, workspace, average_potential, costs);
+    }
+
+    template <class T, class Queue, class Heuristic>
+    std::vector<unsigned int> find_bidirectional_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace,
+                                                            const Heuristic &heuristic)
+    {
+        return find_bidirectional_astar_path(csr, start_position, goal_position, workspace, heuristic, csr);
+    }
+
+    template <class T, class Queue>
+    std::vector<unsigned int> find_bidirectional_astar_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace)
+    {
+        return find_bidirectional_astar_path(csr, start_position, goal_position, workspace, EuclideanHeuristic<T>(csr));
+    }
+
+    // The Graph entry points pin one cost version for the whole query when the graph has dynamic costs
+    template <class Queue = QuadHeap, class T>
+    void compute_bidirectional_dijkstra(Graph<T> &graph, unsigned int start_position, unsigned int goal_position)
+    {
+        BidirectionalWorkspace<Queue> workspace;
+        compute_bidirectional_dijkstra(graph, start_position, goal_position, workspace);
+    }
+
+    template <class T, class Queue>
+    void compute_bidirectional_dijkstra(Graph<T> &graph, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace)
+    {
+        // Pairs the cached components prove unreachable are answered without a search
+        if (!graph.may_reach(start_position, goal_position))
+        {
+            graph.set_dijkstra_path(std::vector<unsigned int>());
+            return;
+        }
+
+        graph.set_dijkstra_path(graph.with_costs([&](const auto &costs)
+                                                 { return find_bidirectional_dijkstra_path(graph.get_csr(), start_position, goal_position, workspace, costs); }));
+    }
+
+    template <class Queue = QuadHeap, class T>
+    void compute_bidirectional_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position)
+    {
+        BidirectionalWorkspace<Queue> workspace;
+        compute_bidirectional_astar(graph, start_position, goal_position, workspace);
+    }
+
+    template <class T, class Queue>
+    void compute_bidirectional_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace)
+    {
+        compute_bidirectional_astar(graph, start_position, goal_position, workspace, EuclideanHeuristic<T>(graph.get_csr()));
+    }
+
+    template <class T, class Queue, class Heuristic>
+    void compute_bidirectional_astar(Graph<T> &graph, unsigned int start_position, unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace, const Heuristic &heuristic)
+    {
+        if (is_landmark_heuristic<Heuristic> && graph.get_dynamic_costs())
+            throw std::runtime_error("Landmark heuristics do not support dynamic edge costs");
+
+        // Pairs the cached components prove unreachable are answered without a search
+        if (!graph.may_reach(start_position, goal_position))
+        {
+            graph.set_astar_path(std::vector<unsigned int>());
+            return;
+        }
+
+        graph.set_astar_path(graph.with_costs([&](const auto &costs)
+                                              { return find_bidirectional_astar_path(graph.get_csr(), start_position, goal_position, workspace, heuristic, costs); }));
+    }
+} // namespace algorithm
+
+#endif // BIDIRECTIONAL_H
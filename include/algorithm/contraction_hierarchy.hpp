@@ -0,0 +1,537 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include "../graph/graph.hpp"
+#include "queue.hpp"
+#include "workspace.hpp"
+#include "bidirectional.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Contraction Hierarchies over the dense indices of a CSRGraph. Vertices are contracted one by one
+    // in order of edge difference plus deleted neighbours; whenever removing a vertex would lose a
+    // shortest path between two of its neighbours a shortcut is added whose cost is the sum of the two
+    // edge costs it replaces. A query then only relaxes edges towards higher ranked vertices from both
+    // ends. Untraversable (-1) edges are dropped before contraction, as the searches skip them anyway.
+    template <class T>
+    class ContractionHierarchy
+    {
+    public:
+        using Index = unsigned int;
+        using EdgeIndex = std::size_t;
+
+        static constexpr Index INVALID_INDEX = UINT_MAX;
+
+        ContractionHierarchy();
+        explicit ContractionHierarchy(const CSRGraph<T> &csr, unsigned int witness_settle_limit = 500);
+
+        // Hierarchy information
+        std::size_t get_num_vertices() const;
+        std::size_t get_num_shortcuts() const;
+        unsigned int get_rank(Index index) const;
+
+        // Upward edges leaving a vertex towards higher ranks, [up_edges_begin, up_edges_end)
+        EdgeIndex up_edges_begin(Index index) const;
+        EdgeIndex up_edges_end(Index index) const;
+        Index get_up_target(EdgeIndex edge) const;
+        double get_up_cost(EdgeIndex edge) const;
+
+        // Edges entering a vertex from higher ranks, stored at the lower endpoint for the backward search
+        EdgeIndex down_edges_begin(Index index) const;
+        EdgeIndex down_edges_end(Index index) const;
+        Index get_down_source(EdgeIndex edge) const;
+        double get_down_cost(EdgeIndex edge) const;
+
+        // Shortest path between two indices, unpacked into original vertex indices (shortcuts record the
+        // contracted vertex they bypass, INVALID_INDEX for original edges)
+        template <class Queue>
+        std::vector<Index> find_path(Index start_index, Index goal_index, BidirectionalWorkspace<Queue> &workspace) const;
+
+    private:
+        std::vector<unsigned int> ranks;
+        std::vector<EdgeIndex> up_offsets;
+        std::vector<Index> up_targets;
+        std::vector<double> up_costs;
+        std::vector<Index> up_middles;
+        std::vector<EdgeIndex> down_offsets;
+        std::vector<Index> down_sources;
+        std::vector<double> down_costs;
+        std::vector<Index> down_middles;
+        std::size_t num_shortcuts;
+
+        Index find_middle(Index from_index, Index to_index) const;
+        void unpack(Index from_index, Index to_index, std::vector<Index> &path) const;
+    };
+
+    // Mutable overlay graph used while contracting
+    template <class T>
+    class ContractionState
+    {
+    public:
+        using Index = unsigned int;
+        using Arc = std::tuple<Index, double, Index>; // Other endpoint, cost, bypassed vertex
+
+        ContractionState(const CSRGraph<T> &csr, unsigned int witness_settle_limit);
+
+        int simulate(Index index);
+        void contract(Index index, std::vector<Arc> &up_arcs, std::vector<Arc> &down_arcs, std::size_t &num_shortcuts);
+        double get_priority(Index index);
+
+    private:
+        std::vector<std::vector<Arc>> out_arcs;
+        std::vector<std::vector<Arc>> in_arcs;
+        std::vector<bool> contracted;
+        std::vector<unsigned int> deleted_neighbours;
+        SearchWorkspace<QuadHeap> witness;
+        unsigned int witness_settle_limit;
+
+        void witness_search(Index source, Index skipped, double max_cost);
+        template <class Callback>
+        void for_each_shortcut(Index index, Callback callback);
+        static void add_arc(std::vector<Arc> &arcs, Index other, double cost, Index middle);
+        static void remove_arc(std::vector<Arc> &arcs, Index other);
+    };
+
+    template <class T>
+    inline ContractionState<T>::ContractionState(const CSRGraph<T> &csr, unsigned int witness_settle_limit)
+        : out_arcs(csr.get_num_vertices()), in_arcs(csr.get_num_vertices()), contracted(csr.get_num_vertices(), false),
+          deleted_neighbours(csr.get_num_vertices(), 0), witness(csr.get_num_vertices()), witness_settle_limit(witness_settle_limit)
+    {
+        // Keep only the cheapest traversable edge between two distinct vertices
+        for (Index v = 0; v < csr.get_num_vertices(); v++)
+        {
+            for (auto edge = csr.edges_begin(v); edge != csr.edges_end(v); edge++)
+            {
+                Index w = csr.get_target(edge);
+                double cost = csr.get_cost(edge);
+                if (cost == -1 || w == v)
+                    continue;
+                add_arc(out_arcs[v], w, cost, UINT_MAX);
+                add_arc(in_arcs[w], v, cost, UINT_MAX);
+            }
+        }
+    }
+
+    template <class T>
+    inline void ContractionState<T>::add_arc(std::vector<Arc> &arcs, Index other, double cost, Index middle)
+    {
+        for (auto &arc : arcs)
+        {
+            if (std::get<0>(arc) == other)
+            {
+                if (cost < std::get<1>(arc))
+                    arc = Arc(other, cost, middle);
+                return;
+            }
+        }
+        arcs.emplace_back(other, cost, middle);
+    }
+
+    template <class T>
+    inline void ContractionState<T>::remove_arc(std::vector<Arc> &arcs, Index other)
+    {
+        for (std::size_t i = 0; i < arcs.size(); i++)
+        {
+            if (std::get<0>(arcs[i]) == other)
+            {
+                arcs[i] = arcs.back();
+                arcs.pop_back();
+                return;
+            }
+        }
+    }
+
+    template <class T>
+    inline void ContractionState<T>::witness_search(Index source, Index skipped, double max_cost)
+    {
+        // Local Dijkstra on the remaining graph that avoids the vertex being contracted
+        witness.reset();
+        auto &queue = witness.get_queue();
+        witness.set_label(source, 0, UINT_MAX);
+        queue.push(source, 0);
+        unsigned int settled = 0;
+        while (!queue.empty() && settled < witness_settle_limit && queue.top_key() <= max_cost)
+        {
+            Index current_index = queue.pop();
+            double current_cost = witness.get_cost(current_index);
+            settled++;
+            for (const auto &arc : out_arcs[current_index])
+            {
+                Index neighbor_index = std::get<0>(arc);
+                if (neighbor_index == skipped)
+                    continue;
+                double total_cost = current_cost + std::get<1>(arc);
+                if (total_cost < witness.get_cost(neighbor_index))
+                {
+                    witness.set_label(neighbor_index, total_cost, current_index);
+                    queue.push(neighbor_index, total_cost);
+                }
+            }
+        }
+    }
+
+    template <class T>
+    template <class Callback>
+    inline void ContractionState<T>::for_each_shortcut(Index index, Callback callback)
+    {
+        double max_out_cost = 0;
+        for (const auto &arc : out_arcs[index])
+            max_out_cost = std::max(max_out_cost, std::get<1>(arc));
+
+        for (const auto &in_arc : in_arcs[index])
+        {
+            Index source = std::get<0>(in_arc);
+            witness_search(source, index, std::get<1>(in_arc) + max_out_cost);
+            for (const auto &out_arc : out_arcs[index])
+            {
+                Index target = std::get<0>(out_arc);
+                if (target == source)
+                    continue;
+                // A shortcut is only needed when no path avoiding the vertex is at least as short
+                double via_cost = std::get<1>(in_arc) + std::get<1>(out_arc);
+                if (witness.get_cost(target) > via_cost)
+                    callback(source, target, via_cost);
+            }
+        }
+    }
+
+    template <class T>
+    inline int ContractionState<T>::simulate(Index index)
+    {
+        int shortcuts = 0;
+        for_each_shortcut(index, [&](Index, Index, double)
+                          { shortcuts++; });
+        return shortcuts;
+    }
+
+    template <class T>
+    inline double ContractionState<T>::get_priority(Index index)
+    {
+        int edge_difference = simulate(index) - int(in_arcs[index].size() + out_arcs[index].size());
+        return edge_difference + double(deleted_neighbours[index]);
+    }
+
+    template <class T>
+    inline void ContractionState<T>::contract(Index index, std::vector<Arc> &up_arcs, std::vector<Arc> &down_arcs, std::size_t &num_shortcuts)
+    {
+        // Every remaining neighbour is ranked higher, so the current arcs become the hierarchy edges
+        up_arcs = out_arcs[index];
+        down_arcs = in_arcs[index];
+
+        std::vector<std::tuple<Index, Index, double>> shortcuts;
+        for_each_shortcut(index, [&](Index source, Index target, double cost)
+                          { shortcuts.emplace_back(source, target, cost); });
+
+        contracted[index] = true;
+        for (const auto &arc : up_arcs)
+        {
+            remove_arc(in_arcs[std::get<0>(arc)], index);
+            deleted_neighbours[std::get<0>(arc)]++;
+        }
+        for (const auto &arc : down_arcs)
+        {
+            remove_arc(out_arcs[std::get<0>(arc)], index);
+            deleted_neighbours[std::get<0>(arc)]++;
+        }
+        out_arcs[index].clear();
+        in_arcs[index].clear();
+
+        for (const auto &shortcut : shortcuts)
+        {
+            add_arc(out_arcs[std::get<0>(shortcut)], std::get<1>(shortcut), std::get<2>(shortcut), index);
+            add_arc(in_arcs[std::get<1>(shortcut)], std::get<0>(shortcut), std::get<2>(shortcut), index);
+        }
+        num_shortcuts += shortcuts.size();
+    }
+
+    template <class T>
+    inline ContractionHierarchy<T>::ContractionHierarchy() : up_offsets(1, 0), down_offsets(1, 0), num_shortcuts(0) {}
+
+    template <class T>
+    inline ContractionHierarchy<T>::ContractionHierarchy(const CSRGraph<T> &csr, unsigned int witness_settle_limit) : num_shortcuts(0)
+    {
+        using Arc = typename ContractionState<T>::Arc;
+        const std::size_t num_vertices = csr.get_num_vertices();
+        ContractionState<T> state(csr, witness_settle_limit);
+        std::vector<std::vector<Arc>> up_arcs(num_vertices), down_arcs(num_vertices);
+        ranks.assign(num_vertices, 0);
+
+        // Initial priorities for every vertex
+        QuadHeap order;
+        order.reserve(num_vertices);
+        for (Index v = 0; v < num_vertices; v++)
+            order.push(v, state.get_priority(v));
+
+        unsigned int rank = 0;
+        while (!order.empty())
+        {
+            // Lazy update: re-evaluate the top vertex and defer it if it is no longer the minimum
+            Index v = order.top();
+            double priority = state.get_priority(v);
+            order.remove(v);
+            if (!order.empty() && priority > order.top_key())
+            {
+                order.push(v, priority);
+                continue;
+            }
+
+            state.contract(v, up_arcs[v], down_arcs[v], num_shortcuts);
+            ranks[v] = rank++;
+
+            // The neighbours lost an edge and gained shortcuts, refresh their priorities
+            for (const auto *arcs : {&up_arcs[v], &down_arcs[v]})
+            {
+                for (const auto &arc : *arcs)
+                {
+                    Index neighbor = std::get<0>(arc);
+                    if (order.contains(neighbor))
+                    {
+                        order.remove(neighbor);
+                        order.push(neighbor, state.get_priority(neighbor));
+                    }
+                }
+            }
+        }
+
+        // Flatten the upward and downward arcs into CSR arrays
+        up_offsets.assign(num_vertices + 1, 0);
+        down_offsets.assign(num_vertices + 1, 0);
+        for (Index v = 0; v < num_vertices; v++)
+        {
+            up_offsets[v + 1] = up_offsets[v] + up_arcs[v].size();
+            down_offsets[v + 1] = down_offsets[v] + down_arcs[v].size();
+            for (const auto &arc : up_arcs[v])
+            {
+                up_targets.push_back(std::get<0>(arc));
+                up_costs.push_back(std::get<1>(arc));
+                up_middles.push_back(std::get<2>(arc));
+            }
+            for (const auto &arc : down_arcs[v])
+            {
+                down_sources.push_back(std::get<0>(arc));
+                down_costs.push_back(std::get<1>(arc));
+                down_middles.push_back(std::get<2>(arc));
+            }
+        }
+    }
+
+    template <class T>
+    inline std::size_t ContractionHierarchy<T>::get_num_vertices() const
+    {
+        return ranks.size();
+    }
+
+    template <class T>
+    inline std::size_t ContractionHierarchy<T>::get_num_shortcuts() const
+    {
+        return num_shortcuts;
+    }
+
+    template <class T>
+    inline unsigned int ContractionHierarchy<T>::get_rank(Index index) const
+    {
+        return ranks[index];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::EdgeIndex ContractionHierarchy<T>::up_edges_begin(Index index) const
+    {
+        return up_offsets[index];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::EdgeIndex ContractionHierarchy<T>::up_edges_end(Index index) const
+    {
+        return up_offsets[index + 1];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::Index ContractionHierarchy<T>::get_up_target(EdgeIndex edge) const
+    {
+        return up_targets[edge];
+    }
+
+    template <class T>
+    inline double ContractionHierarchy<T>::get_up_cost(EdgeIndex edge) const
+    {
+        return up_costs[edge];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::EdgeIndex ContractionHierarchy<T>::down_edges_begin(Index index) const
+    {
+        return down_offsets[index];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::EdgeIndex ContractionHierarchy<T>::down_edges_end(Index index) const
+    {
+        return down_offsets[index + 1];
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::Index ContractionHierarchy<T>::get_down_source(EdgeIndex edge) const
+    {
+        return down_sources[edge];
+    }
+
+    template <class T>
+    inline double ContractionHierarchy<T>::get_down_cost(EdgeIndex edge) const
+    {
+        return down_costs[edge];
+    }
+
+    template <class T>
+    template <class Queue>
+    inline std::vector<typename ContractionHierarchy<T>::Index> ContractionHierarchy<T>::find_path(Index start_index, Index goal_index, BidirectionalWorkspace<Queue> &workspace) const
+    {
+        std::vector<Index> path;
+        if (start_index == goal_index)
+            return path;
+
+        auto &forward = workspace.forward;
+        auto &backward = workspace.backward;
+        forward.resize(get_num_vertices());
+        backward.resize(get_num_vertices());
+        forward.reset();
+        backward.reset();
+        auto &forward_queue = forward.get_queue();
+        auto &backward_queue = backward.get_queue();
+
+        forward.set_label(start_index, 0, INVALID_INDEX);
+        forward_queue.push(start_index, 0);
+        backward.set_label(goal_index, 0, INVALID_INDEX);
+        backward_queue.push(goal_index, 0);
+
+        // Both upward searches run until their smallest key can no longer improve the best meeting cost
+        double best_cost = std::numeric_limits<double>::infinity();
+        Index meeting_index = INVALID_INDEX;
+        bool forward_turn = true;
+        while (true)
+        {
+            bool forward_done = forward_queue.empty() || forward_queue.top_key() >= best_cost;
+            bool backward_done = backward_queue.empty() || backward_queue.top_key() >= best_cost;
+            if (forward_done && backward_done)
+                break;
+            forward_turn = backward_done || (!forward_done && !forward_turn);
+
+            auto &current = forward_turn ? forward : backward;
+            auto &other = forward_turn ? backward : forward;
+            Index current_index = current.get_queue().pop();
+            double current_cost = current.get_cost(current_index);
+            if (other.is_reached(current_index) && current_cost + other.get_cost(current_index) < best_cost)
+            {
+                best_cost = current_cost + other.get_cost(current_index);
+                meeting_index = current_index;
+            }
+
+            EdgeIndex begin = forward_turn ? up_offsets[current_index] : down_offsets[current_index];
+            EdgeIndex end = forward_turn ? up_offsets[current_index + 1] : down_offsets[current_index + 1];
+            for (EdgeIndex edge = begin; edge < end; edge++)
+            {
+                Index neighbor_index = forward_turn ? up_targets[edge] : down_sources[edge];
+                double total_cost = current_cost + (forward_turn ? up_costs[edge] : down_costs[edge]);
+                if (total_cost < current.get_cost(neighbor_index))
+                {
+                    current.set_label(neighbor_index, total_cost, current_index);
+                    current.get_queue().push(neighbor_index, total_cost);
+                }
+            }
+        }
+
+        if (meeting_index == INVALID_INDEX)
+            return path;
+
+        // Hierarchy path start -> meeting vertex -> goal, each hop unpacked into original edges
+        std::vector<Index> hops;
+        for (Index index = meeting_index; index != INVALID_INDEX; index = forward.get_previous(index))
+            hops.push_back(index);
+        std::reverse(hops.begin(), hops.end());
+        for (Index index = backward.get_previous(meeting_index); index != INVALID_INDEX; index = backward.get_previous(index))
+            hops.push_back(index);
+
+        path.push_back(hops.front());
+        for (std::size_t i = 0; i + 1 < hops.size(); i++)
+            unpack(hops[i], hops[i + 1], path);
+        return path;
+    }
+
+    template <class T>
+    inline typename ContractionHierarchy<T>::Index ContractionHierarchy<T>::find_middle(Index from_index, Index to_index) const
+    {
+        // Each hierarchy edge is stored once, at its lower ranked endpoint
+        if (ranks[from_index] < ranks[to_index])
+        {
+            for (EdgeIndex edge = up_offsets[from_index]; edge < up_offsets[from_index + 1]; edge++)
+            {
+                if (up_targets[edge] == to_index)
+                    return up_middles[edge];
+            }
+        }
+        else
+        {
+            for (EdgeIndex edge = down_offsets[to_index]; edge < down_offsets[to_index + 1]; edge++)
+            {
+                if (down_sources[edge] == from_index)
+                    return down_middles[edge];
+            }
+        }
+        return INVALID_INDEX;
+    }
+
+    template <class T>
+    inline void ContractionHierarchy<T>::unpack(Index from_index, Index to_index, std::vector<Index> &path) const
+    {
+        // Expand shortcuts depth first without recursion, appending every vertex after from_index
+        std::vector<std::pair<Index, Index>> stack;
+        stack.emplace_back(from_index, to_index);
+        while (!stack.empty())
+        {
+            auto hop = stack.back();
+            stack.pop_back();
+            Index middle = find_middle(hop.first, hop.second);
+            if (middle == INVALID_INDEX)
+            {
+                path.push_back(hop.second);
+                continue;
+            }
+            stack.emplace_back(middle, hop.second);
+            stack.emplace_back(hop.first, middle);
+        }
+    }
+
+    template <class T, class Queue>
+    std::vector<unsigned int> find_contraction_hierarchy_path(const CSRGraph<T> &csr, const ContractionHierarchy<T> &hierarchy, unsigned int start_position,
+                                                              unsigned int goal_position, BidirectionalWorkspace<Queue> &workspace)
+    {
+        std::vector<unsigned int> path;
+        for (auto index : hierarchy.find_path(csr.get_index(start_position), csr.get_index(goal_position), workspace))
+            path.push_back(csr.get_position(index));
+        return path;
+    }
+
+    // The shortcuts bake in the costs the hierarchy was built from, so dynamic costs are rejected
+    template <class Queue = QuadHeap, class T>
+    void compute_contraction_hierarchy(Graph<T> &graph, const ContractionHierarchy<T> &hierarchy, unsigned int start_position, unsigned int goal_position)
+    {
+        if (graph.get_dynamic_costs())
+            throw std::runtime_error("Contraction hierarchies do not support dynamic edge costs");
+
+        // Pairs the cached components prove unreachable are answered without a search
+        if (!graph.may_reach(start_position, goal_position))
+        {
+            graph.set_dijkstra_path(std::vector<unsigned int>());
+            return;
+        }
+
+        BidirectionalWorkspace<Queue> workspace;
+        graph.set_dijkstra_path(find_contraction_hierarchy_path(graph.get_csr(), hierarchy, start_position, goal_position, workspace));
+    }
+} // namespace algorithm
+
+#endif // CONTRACTION_HIERARCHY_H
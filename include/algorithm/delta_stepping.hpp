@@ -0,0 +1,310 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "../graph/graph.hpp"
+#include "../parallel/thread_pool.hpp"
+#include "workspace.hpp"
+#include "dijkstra.hpp"
+#include "path.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    struct DeltaSteppingOptions
+    {
+        double delta = 0;              // Bucket width, 0 picks the mean traversable edge cost
+        std::size_t chunk_size = 1024; // Frontier vertices handed to a thread at a time
+    };
+
+    // Single-source shortest paths to every reachable vertex with Meyer and Sanders' delta-stepping.
+    // Vertices are bucketed by cost in ranges of width delta. The bucket with the cheapest vertices is
+    // emptied in rounds that relax the light edges (cost <= delta) of its whole frontier in parallel,
+    // since those may land in the same bucket again; the heavy edges of every vertex the bucket settled
+    // are relaxed once at the end. Costs are lowered with an atomic minimum on their bit patterns, which
+    // order like the values for non-negative doubles.
+    //
+    // The results are written to the workspace exactly as run_dijkstra leaves them, so reconstruct_path
+    // and compute_dijkstra's consumers work unchanged. Costs are the same as Dijkstra's. Among equally
+    // cheap predecessors the lowest vertex index is chosen, so the output does not depend on the number
+    // of threads, although a tie may resolve differently than in a sequential Dijkstra run.
+    template <class T, class Queue, class Costs>
+    SettledStats run_delta_stepping(const CSRGraph<T> &csr, unsigned int start_position, SearchWorkspace<Queue> &workspace,
+                                    parallel::ThreadPool &pool, const DeltaSteppingOptions &options, const Costs &costs)
+    {
+        using Index = typename CSRGraph<T>::Index;
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+        struct Entry
+        {
+            Index vertex;
+            double cost;
+        };
+
+        const Index start_index = csr.get_index(start_position);
+        const std::size_t num_vertices = csr.get_num_vertices();
+        const unsigned int num_workers = pool.get_num_threads();
+        const std::size_t chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+
+        // Run body(worker, first, last) over [0, count) in chunks, on the calling thread when one
+        // chunk is enough
+        auto for_each_chunk = [&](std::size_t count, auto body)
+        {
+            const std::size_t num_chunks = (count + chunk_size - 1) / chunk_size;
+            if (num_chunks <= 1)
+            {
+                body(0u, std::size_t(0), count);
+                return;
+            }
+            std::atomic<unsigned int> next_worker(0);
+            auto make_worker = [&]()
+            { return next_worker++; };
+            parallel::for_each_index(pool, num_chunks, make_worker, [&](unsigned int &worker, std::size_t chunk)
+                                     { body(worker, chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size)); });
+        };
+
+        // Bucket width and the largest edge cost, which bounds how far ahead a relaxation can reach
+        std::vector<double> cost_sums(num_workers, 0), max_costs(num_workers, 0);
+        std::vector<std::size_t> cost_counts(num_workers, 0);
+        for_each_chunk(num_vertices, [&](unsigned int worker, std::size_t first, std::size_t last)
+                       {
+            for (EdgeIndex edge = csr.edges_begin(first); edge != csr.edges_begin(last); edge++)
+            {
+                double cost = costs.get_cost(edge);
+                if (cost == -1)
+                    continue;
+                cost_sums[worker] += cost;
+                cost_counts[worker]++;
+                max_costs[worker] = std::max(max_costs[worker], cost);
+            } });
+        double cost_sum = 0, max_cost = 0;
+        std::size_t cost_count = 0;
+        for (unsigned int worker = 0; worker < num_workers; worker++)
+        {
+            cost_sum += cost_sums[worker];
+            cost_count += cost_counts[worker];
+            max_cost = std::max(max_cost, max_costs[worker]);
+        }
+        double delta = options.delta > 0 ? options.delta : (cost_count ? cost_sum / cost_count : 1);
+        if (!(delta > 0))
+            delta = 1; // Every edge is free
+        const std::size_t num_slots = static_cast<std::size_t>(max_cost / delta) + 2;
+        auto bucket_of = [&](double cost)
+        { return static_cast<std::size_t>(cost / delta); };
+
+        auto to_bits = [](double cost)
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &cost, sizeof(bits));
+            return bits;
+        };
+        const std::uint64_t unreached = to_bits(std::numeric_limits<double>::infinity());
+        std::unique_ptr<std::atomic<std::uint64_t>[]> distances(new std::atomic<std::uint64_t>[num_vertices]);
+        for_each_chunk(num_vertices, [&](unsigned int, std::size_t first, std::size_t last)
+                       {
+            for (std::size_t i = first; i < last; i++)
+                distances[i].store(unreached, std::memory_order_relaxed); });
+        auto get_distance = [&](Index index)
+        {
+            double cost;
+            std::uint64_t bits = distances[index].load(std::memory_order_relaxed);
+            std::memcpy(&cost, &bits, sizeof(cost));
+            return cost;
+        };
+        auto lower_distance = [&](Index index, double cost)
+        {
+            std::uint64_t bits = to_bits(cost);
+            std::uint64_t current = distances[index].load(std::memory_order_relaxed);
+            while (bits < current)
+            {
+                if (distances[index].compare_exchange_weak(current, bits, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        };
+
+        // Cyclic buckets, an entry is stale once its vertex got cheaper. Improvements found by the
+        // workers are collected per worker and bucketed between the parallel phases.
+        std::vector<std::vector<Entry>> buckets(num_slots);
+        std::vector<std::vector<Entry>> requests(num_workers);
+        std::vector<std::size_t> relaxed(num_workers, 0);
+        std::size_t pending = 1;
+        distances[start_index].store(to_bits(0), std::memory_order_relaxed);
+        buckets[0].push_back(Entry{start_index, 0});
+
+        auto relax = [&](const std::vector<Entry> &entries, bool light)
+        {
+            for_each_chunk(entries.size(), [&](unsigned int worker, std::size_t first, std::size_t last)
+                           {
+                for (std::size_t i = first; i < last; i++)
+                {
+                    const Entry &entry = entries[i];
+                    for (EdgeIndex edge = csr.edges_begin(entry.vertex); edge != csr.edges_end(entry.vertex); edge++)
+                    {
+                        double cost = costs.get_cost(edge);
+                        if (cost == -1 || (cost <= delta) != light)
+                            continue;
+                        relaxed[worker]++;
+                        Index neighbor_index = csr.get_target(edge);
+                        if (lower_distance(neighbor_index, entry.cost + cost))
+                            requests[worker].push_back(Entry{neighbor_index, entry.cost + cost});
+                    }
+                } });
+            for (auto &worker_requests : requests)
+            {
+                for (const auto &request : worker_requests)
+                    buckets[bucket_of(request.cost) % num_slots].push_back(request);
+                pending += worker_requests.size();
+                worker_requests.clear();
+            }
+        };
+
+        std::vector<Entry> frontier, settled;
+        std::size_t current_bucket = 0;
+        while (pending > 0)
+        {
+            while (buckets[current_bucket % num_slots].empty())
+                current_bucket++;
+            auto &bucket = buckets[current_bucket % num_slots];
+
+            // Light edges may refill the bucket, so it is emptied in rounds
+            settled.clear();
+            while (!bucket.empty())
+            {
+                frontier.clear();
+                frontier.swap(bucket);
+                pending -= frontier.size();
+                frontier.erase(std::remove_if(frontier.begin(), frontier.end(), [&](const Entry &entry)
+                                              { return get_distance(entry.vertex) != entry.cost; }),
+                               frontier.end());
+                settled.insert(settled.end(), frontier.begin(), frontier.end());
+                relax(frontier, true);
+            }
+
+            // A vertex may have been settled more than once with falling costs, only its last entry counts
+            settled.erase(std::remove_if(settled.begin(), settled.end(), [&](const Entry &entry)
+                                         { return get_distance(entry.vertex) != entry.cost; }),
+                          settled.end());
+            relax(settled, false);
+            current_bucket++;
+        }
+
+        // Predecessors: the lowest tight predecessor over a positive edge. Vertices reached only over
+        // free edges from equally cheap vertices are left for a search along those edges, since picking
+        // among free edges independently could close a cycle.
+        std::vector<Index> previous(num_vertices, CSRGraph<T>::INVALID_INDEX);
+        std::vector<std::vector<Index>> unanchored(num_workers);
+        for_each_chunk(num_vertices, [&](unsigned int worker, std::size_t first, std::size_t last)
+                       {
+            for (Index index = first; index < last; index++)
+            {
+                double cost = get_distance(index);
+                if (index == start_index || cost == std::numeric_limits<double>::infinity())
+                    continue;
+                for (auto in_edge = csr.in_edges_begin(index); in_edge != csr.in_edges_end(index); in_edge++)
+                {
+                    double edge_cost = costs.get_cost(csr.get_forward_edge(in_edge));
+                    Index source = csr.get_source(in_edge);
+                    if (edge_cost > 0 && get_distance(source) + edge_cost == cost && source < previous[index])
+                        previous[index] = source;
+                }
+                if (previous[index] == CSRGraph<T>::INVALID_INDEX)
+                    unanchored[worker].push_back(index);
+            } });
+
+        std::vector<Index> free_vertices;
+        for (const auto &worker_unanchored : unanchored)
+            free_vertices.insert(free_vertices.end(), worker_unanchored.begin(), worker_unanchored.end());
+        if (!free_vertices.empty())
+        {
+            std::sort(free_vertices.begin(), free_vertices.end());
+            auto is_resolved = [&](Index index)
+            { return index == start_index || previous[index] != CSRGraph<T>::INVALID_INDEX; };
+            std::vector<Index> queue;
+            for (auto index : free_vertices)
+            {
+                for (auto in_edge = csr.in_edges_begin(index); in_edge != csr.in_edges_end(index); in_edge++)
+                {
+                    Index source = csr.get_source(in_edge);
+                    if (costs.get_cost(csr.get_forward_edge(in_edge)) == 0 && get_distance(source) == get_distance(index) &&
+                        is_resolved(source) && source < previous[index])
+                        previous[index] = source;
+                }
+                if (previous[index] != CSRGraph<T>::INVALID_INDEX)
+                    queue.push_back(index);
+            }
+            for (std::size_t head = 0; head < queue.size(); head++)
+            {
+                Index current_index = queue[head];
+                for (EdgeIndex edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+                {
+                    Index neighbor_index = csr.get_target(edge);
+                    if (costs.get_cost(edge) == 0 && !is_resolved(neighbor_index) && get_distance(neighbor_index) == get_distance(current_index))
+                    {
+                        previous[neighbor_index] = current_index;
+                        queue.push_back(neighbor_index);
+                    }
+                }
+            }
+        }
+
+        // Hand the labels over in the workspace layout used by the sequential searches
+        workspace.resize(num_vertices);
+        workspace.reset();
+        std::vector<SettledStats> worker_stats(num_workers);
+        for_each_chunk(num_vertices, [&](unsigned int worker, std::size_t first, std::size_t last)
+                       {
+            for (Index index = first; index < last; index++)
+            {
+                double cost = get_distance(index);
+                if (cost == std::numeric_limits<double>::infinity())
+                    continue;
+                workspace.set_label(index, cost, previous[index]);
+                worker_stats[worker].settled_vertices++;
+                worker_stats[worker].max_settled_cost = std::max(worker_stats[worker].max_settled_cost, cost);
+            } });
+
+        SettledStats stats;
+        for (unsigned int worker = 0; worker < num_workers; worker++)
+        {
+            stats.settled_vertices += worker_stats[worker].settled_vertices;
+            stats.max_settled_cost = std::max(stats.max_settled_cost, worker_stats[worker].max_settled_cost);
+            stats.relaxed_edges += relaxed[worker];
+        }
+        return stats;
+    }
+
+    template <class T, class Queue>
+    SettledStats run_delta_stepping(const CSRGraph<T> &csr, unsigned int start_position, SearchWorkspace<Queue> &workspace,
+                                    parallel::ThreadPool &pool, const DeltaSteppingOptions &options = DeltaSteppingOptions())
+    {
+        return run_delta_stepping(csr, start_position, workspace, pool, options, csr);
+    }
+
+    // Full single-source run from the start, stored as the graph's Dijkstra path to the end. Pairs the
+    // cached components prove unreachable skip the run and leave the workspace untouched.
+    template <class T, class Queue>
+    void compute_delta_stepping(Graph<T> &graph, unsigned int start_position, unsigned int end_position, SearchWorkspace<Queue> &workspace,
+                                parallel::ThreadPool &pool, const DeltaSteppingOptions &options = DeltaSteppingOptions())
+    {
+        if (!graph.may_reach(start_position, end_position))
+        {
+            graph.set_dijkstra_path(std::vector<unsigned int>());
+            return;
+        }
+
+        const CSRGraph<T> &csr = graph.get_csr();
+        graph.set_dijkstra_path(graph.with_costs([&](const auto &costs)
+                                                 {
+            run_delta_stepping(csr, start_position, workspace, pool, options, costs);
+            return reconstruct_path(csr, workspace, csr.get_index(start_position), csr.get_index(end_position)); }));
+    }
+} // namespace algorithm
+
+#endif // DELTA_STEPPING_H
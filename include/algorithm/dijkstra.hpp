@@ -2,74 +2,203 @@
 #define DIJKSTRA_H
 
 #include "../graph/graph.hpp"
-#include <queue>
+#include "workspace.hpp"
+#include "path.hpp"
 
 using namespace graph;
 
 namespace algorithm
 {
-    template <class T>
-    void compute_dijkstra(Graph<T> &graph, unsigned int start_position, unsigned int end_position)
+    // Stopping rule of a Dijkstra run
+    enum class DijkstraMode
+    {
+        FULL,       // Settle every reachable vertex
+        TARGET,     // Stop once the single target is settled
+        TARGET_SET, // Stop once every target of the set is settled
+        RADIUS      // Stop once the next vertex lies beyond the cost radius (isochrone)
+    };
+
+    struct DijkstraQuery
+    {
+        DijkstraMode mode = DijkstraMode::FULL;
+        std::vector<unsigned int> targets; // Target positions for TARGET and TARGET_SET
+        double radius = std::numeric_limits<double>::infinity();
+        bool reverse = false; // Follow incoming edges, so costs are towards the start instead of from it
+    };
+
+    // Summary of the settled set of a Dijkstra run
+    struct SettledStats
     {
+        std::size_t settled_vertices = 0;
+        std::size_t relaxed_edges = 0;
+        std::size_t targets_settled = 0;
+        double max_settled_cost = 0;
+    };
 
-        using DistPos = std::pair<double, unsigned int>;
-        std::unordered_map<unsigned int, double> costs;
-        std::unordered_map<unsigned int, unsigned int> previous;
-        std::priority_queue<DistPos, std::vector<DistPos>, std::greater<DistPos>> queue;
+    // Run Dijkstra from the start position until the query's stopping rule is met. The final costs
+    // and predecessors of every settled vertex are left in the workspace, and the work done in its
+    // stats when it is instrumented. Edge costs are read from
+    // costs, anything with get_cost(edge): the graph itself or a pinned CostSnapshot of dynamic costs.
+    template <class T, class Queue, class Costs>
+    SettledStats run_dijkstra(const CSRGraph<T> &csr, unsigned int start_position, const DijkstraQuery &query, SearchWorkspace<Queue> &workspace,
+                              const Costs &costs)
+    {
+        using Index = typename CSRGraph<T>::Index;
+        PhaseTimer timer;
+        const Index start_index = csr.get_index(start_position);
+        workspace.resize(csr.get_num_vertices());
+        workspace.reset();
+        auto &queue = workspace.get_queue();
+        SettledStats stats;
+        const bool instrumented = workspace.is_instrumented();
+        auto &search_stats = workspace.get_stats();
 
-        for (const auto &entry : graph.get_vertices())
+        // Targets are kept sorted so a settled vertex is checked with a binary search
+        auto &targets = workspace.get_index_scratch();
+        targets.clear();
+        if (query.mode == DijkstraMode::TARGET || query.mode == DijkstraMode::TARGET_SET)
         {
-            auto vertex_pos = entry.first;
-            costs[vertex_pos] = (vertex_pos == start_position) ? 0 : std::numeric_limits<double>::infinity();
-            previous[vertex_pos] = UINT_MAX;
-            queue.push(std::make_pair(costs[vertex_pos], vertex_pos));
+            for (auto position : query.targets)
+                targets.push_back(csr.get_index(position));
+            std::sort(targets.begin(), targets.end());
+            targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+            if (query.mode == DijkstraMode::TARGET && targets.size() != 1)
+                throw std::invalid_argument("Dijkstra target mode requires exactly one target");
         }
 
         // The distance to the start vertex is 0
-        costs[start_position] = 0.0;
-        queue.push({0.0, start_position});
+        workspace.set_label(start_index, 0.0, CSRGraph<T>::INVALID_INDEX);
+        queue.push(start_index, 0.0);
+        if (instrumented)
+        {
+            search_stats = SearchStats();
+            search_stats.algorithm = "dijkstra";
+            search_stats.start_position = start_position;
+            search_stats.queue_pushes = search_stats.peak_queue_size = 1;
+            search_stats.init_ms = timer.lap();
+        }
 
         while (!queue.empty())
         {
-            unsigned int current_vertex_pos = queue.top().second;
-            queue.pop();
+            if (query.mode == DijkstraMode::RADIUS && queue.top_key() > query.radius)
+                break;
+
+            Index current_index = queue.pop();
+            double current_cost = workspace.get_cost(current_index);
+            stats.settled_vertices++;
+            stats.max_settled_cost = current_cost;
+
+            if (!targets.empty() && std::binary_search(targets.begin(), targets.end(), current_index))
+            {
+                if (++stats.targets_settled == targets.size())
+                    break;
+            }
 
-            // Explore the neighbors of the current vertex
-            for (const auto &edge : graph.get_vertex(current_vertex_pos)->get_edges())
+            // Explore the neighbors of the current vertex, over incoming edges for a reverse search
+            auto edges_begin = query.reverse ? csr.in_edges_begin(current_index) : csr.edges_begin(current_index);
+            auto edges_end = query.reverse ? csr.in_edges_end(current_index) : csr.edges_end(current_index);
+            for (auto edge = edges_begin; edge != edges_end; edge++)
             {
-                auto neighbor_vertex_pos = edge->get_destination()->get_position();
-                auto cost = edge->get_cost();
+                Index neighbor_index = query.reverse ? csr.get_source(edge) : csr.get_target(edge);
+                double cost = costs.get_cost(query.reverse ? csr.get_forward_edge(edge) : edge);
                 if (cost == -1)
                     continue; // Skip untraversable edges
 
                 // Calculate the total distance to the neighbor vertex via the current vertex
-                double total_cost = costs[current_vertex_pos] + cost;
+                double total_cost = current_cost + cost;
+                stats.relaxed_edges++;
 
-                if (total_cost < costs[neighbor_vertex_pos])
+                if (total_cost < workspace.get_cost(neighbor_index))
                 {
-                    costs[neighbor_vertex_pos] = total_cost;
-                    previous[neighbor_vertex_pos] = current_vertex_pos;
-                    queue.push({total_cost, neighbor_vertex_pos});
+                    if (instrumented)
+                    {
+                        search_stats.queue_pushes++;
+                        search_stats.decrease_keys += queue.contains(neighbor_index);
+                    }
+                    workspace.set_label(neighbor_index, total_cost, current_index);
+                    queue.push(neighbor_index, total_cost);
+                    if (instrumented)
+                        search_stats.peak_queue_size = std::max(search_stats.peak_queue_size, queue.size());
                 }
             }
         }
-        // Reconstruct the shortest path from the previous map
-        std::vector<unsigned int> path;
-        if (previous[end_position] == UINT_MAX)
+
+        if (instrumented)
         {
-            // No path found
-            graph.set_dijkstra_path(path); // Set an empty path
-            return;
+            search_stats.settled_vertices = stats.settled_vertices;
+            search_stats.relaxed_edges = stats.relaxed_edges;
+            search_stats.search_ms = timer.lap();
+        }
+        return stats;
+    }
+
+    template <class T, class Queue>
+    SettledStats run_dijkstra(const CSRGraph<T> &csr, unsigned int start_position, const DijkstraQuery &query, SearchWorkspace<Queue> &workspace)
+    {
+        return run_dijkstra(csr, start_position, query, workspace, csr);
+    }
+
+    template <class T, class Queue, class Costs>
+    std::vector<unsigned int> find_dijkstra_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int end_position, SearchWorkspace<Queue> &workspace,
+                                                 const Costs &costs)
+    {
+        DijkstraQuery query;
+        query.mode = DijkstraMode::TARGET;
+        query.targets.push_back(end_position);
+        run_dijkstra(csr, start_position, query, workspace, costs);
+
+        // Reconstruct the shortest path from the workspace predecessors
+        PhaseTimer timer;
+        auto path = reconstruct_path(csr, workspace, csr.get_index(start_position), csr.get_index(end_position));
+        if (workspace.is_instrumented())
+        {
+            auto &search_stats = workspace.get_stats();
+            search_stats.end_position = end_position;
+            search_stats.path_found = !path.empty();
+            search_stats.path_ms = timer.lap();
+            workspace.report_stats();
         }
-        unsigned int current_vertex_pos = end_position;
-        while (current_vertex_pos != UINT_MAX && current_vertex_pos != start_position)
+        return path;
+    }
+
+    template <class T, class Queue>
+    std::vector<unsigned int> find_dijkstra_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int end_position, SearchWorkspace<Queue> &workspace)
+    {
+        return find_dijkstra_path(csr, start_position, end_position, workspace, csr);
+    }
+
+    template <class Queue = QuadHeap, class T>
+    std::vector<unsigned int> find_dijkstra_path(const CSRGraph<T> &csr, unsigned int start_position, unsigned int end_position)
+    {
+        SearchWorkspace<Queue> workspace(csr.get_num_vertices());
+        return find_dijkstra_path(csr, start_position, end_position, workspace);
+    }
+
+    template <class Queue = QuadHeap, class T>
+    void compute_dijkstra(Graph<T> &graph, unsigned int start_position, unsigned int end_position)
+    {
+        SearchWorkspace<Queue> workspace;
+        compute_dijkstra(graph, start_position, end_position, workspace);
+    }
+
+    template <class T, class Queue>
+    void compute_dijkstra(Graph<T> &graph, unsigned int start_position, unsigned int end_position, SearchWorkspace<Queue> &workspace)
+    {
+        // Pairs the cached components prove unreachable are answered without a search
+        if (!graph.may_reach(start_position, end_position))
         {
-            path.push_back(current_vertex_pos);
-            current_vertex_pos = previous[current_vertex_pos];
+            if (workspace.is_instrumented())
+            {
+                workspace.get_stats() = SearchStats{"dijkstra", start_position, end_position};
+                workspace.report_stats();
+            }
+            graph.set_dijkstra_path(std::vector<unsigned int>());
+            return;
         }
-        path.push_back(start_position);
-        std::reverse(path.begin(), path.end());
-        graph.set_dijkstra_path(path);
+
+        // One cost version is pinned for the whole query when the graph has dynamic costs
+        graph.set_dijkstra_path(graph.with_costs([&](const auto &costs)
+                                                 { return find_dijkstra_path(graph.get_csr(), start_position, end_position, workspace, costs); }));
     }
 } // namespace algorithm
 
@@ -0,0 +1,183 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include "../graph/graph.hpp"
+#include "../parallel/thread_pool.hpp"
+#include "workspace.hpp"
+#include "dijkstra.hpp"
+#include "contraction_hierarchy.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Dense source x target cost matrix, rows are sources and columns targets. Unreachable pairs cost
+    // infinity. The optional predecessor matrix holds the position of the vertex preceding the target on
+    // a shortest path (UINT_MAX for unreachable pairs and on the diagonal), enough to walk paths back
+    // when the targets cover the vertices of interest.
+    struct DistanceMatrix
+    {
+        static constexpr unsigned int NO_PREVIOUS = UINT_MAX;
+
+        std::vector<unsigned int> sources;
+        std::vector<unsigned int> targets;
+        std::vector<double> costs;
+        std::vector<unsigned int> previous;
+
+        std::size_t get_num_rows() const { return sources.size(); }
+        std::size_t get_num_columns() const { return targets.size(); }
+        bool has_predecessors() const { return !previous.empty(); }
+        double get_cost(std::size_t row, std::size_t column) const { return costs[row * targets.size() + column]; }
+        unsigned int get_previous(std::size_t row, std::size_t column) const { return previous[row * targets.size() + column]; }
+    };
+
+    // One multi-target Dijkstra per source, stopped once every target is settled, with the sources
+    // spread over the pool's threads
+    template <class Queue = QuadHeap, class T>
+    DistanceMatrix distance_matrix(const CSRGraph<T> &csr, const std::vector<unsigned int> &sources, const std::vector<unsigned int> &targets,
+                                   parallel::ThreadPool &pool, bool with_predecessors = false)
+    {
+        DistanceMatrix matrix;
+        matrix.sources = sources;
+        matrix.targets = targets;
+        matrix.costs.assign(sources.size() * targets.size(), std::numeric_limits<double>::infinity());
+        if (with_predecessors)
+            matrix.previous.assign(sources.size() * targets.size(), DistanceMatrix::NO_PREVIOUS);
+
+        std::vector<typename CSRGraph<T>::Index> target_indices;
+        for (auto position : targets)
+            target_indices.push_back(csr.get_index(position));
+        for (auto position : sources)
+            csr.get_index(position); // Throws before any worker starts
+        if (sources.empty() || targets.empty())
+            return matrix; // An empty target set would let every search run to exhaustion
+
+        DijkstraQuery query;
+        query.mode = DijkstraMode::TARGET_SET;
+        query.targets = targets;
+
+        parallel::for_each_index(
+            pool, sources.size(), [&]()
+            { return SearchWorkspace<Queue>(csr.get_num_vertices()); },
+            [&](SearchWorkspace<Queue> &workspace, std::size_t row)
+            {
+                run_dijkstra(csr, sources[row], query, workspace);
+                for (std::size_t column = 0; column < targets.size(); column++)
+                {
+                    matrix.costs[row * targets.size() + column] = workspace.get_cost(target_indices[column]);
+                    auto previous_index = workspace.get_previous(target_indices[column]);
+                    if (with_predecessors && previous_index != CSRGraph<T>::INVALID_INDEX)
+                        matrix.previous[row * targets.size() + column] = csr.get_position(previous_index);
+                }
+            });
+        return matrix;
+    }
+
+    // Bucket-based many-to-many on a Contraction Hierarchy: an upward search over the incoming edges of
+    // every target leaves (target, cost) entries in the buckets of the vertices it settles, then the
+    // upward search of every source scans the buckets of the vertices it settles. Each pair meets at
+    // the highest vertex of its shortest path, so both sides only ever explore their upward cones.
+    // Paths run over shortcuts, so no predecessor matrix is produced.
+    template <class Queue = QuadHeap, class T>
+    DistanceMatrix distance_matrix(const CSRGraph<T> &csr, const ContractionHierarchy<T> &hierarchy, const std::vector<unsigned int> &sources,
+                                   const std::vector<unsigned int> &targets, parallel::ThreadPool &pool)
+    {
+        using Index = typename ContractionHierarchy<T>::Index;
+        DistanceMatrix matrix;
+        matrix.sources = sources;
+        matrix.targets = targets;
+        matrix.costs.assign(sources.size() * targets.size(), std::numeric_limits<double>::infinity());
+
+        std::vector<Index> source_indices, target_indices;
+        for (auto position : sources)
+            source_indices.push_back(csr.get_index(position));
+        for (auto position : targets)
+            target_indices.push_back(csr.get_index(position));
+        if (sources.empty() || targets.empty())
+            return matrix;
+
+        // Settle every vertex of the upward cone of a vertex, over up edges or reversed down edges
+        auto upward_search = [&](SearchWorkspace<Queue> &workspace, Index start_index, bool forward, auto settle)
+        {
+            workspace.reset();
+            auto &queue = workspace.get_queue();
+            workspace.set_label(start_index, 0, ContractionHierarchy<T>::INVALID_INDEX);
+            queue.push(start_index, 0);
+            while (!queue.empty())
+            {
+                Index current_index = queue.pop();
+                double current_cost = workspace.get_cost(current_index);
+                settle(current_index, current_cost);
+                auto begin = forward ? hierarchy.up_edges_begin(current_index) : hierarchy.down_edges_begin(current_index);
+                auto end = forward ? hierarchy.up_edges_end(current_index) : hierarchy.down_edges_end(current_index);
+                for (auto edge = begin; edge != end; edge++)
+                {
+                    Index neighbor_index = forward ? hierarchy.get_up_target(edge) : hierarchy.get_down_source(edge);
+                    double total_cost = current_cost + (forward ? hierarchy.get_up_cost(edge) : hierarchy.get_down_cost(edge));
+                    if (total_cost < workspace.get_cost(neighbor_index))
+                    {
+                        workspace.set_label(neighbor_index, total_cost, current_index);
+                        queue.push(neighbor_index, total_cost);
+                    }
+                }
+            }
+        };
+
+        // Backward cones of the targets, then the bucket entries grouped by vertex in CSR form
+        std::vector<std::vector<std::pair<Index, double>>> cones(targets.size());
+        parallel::for_each_index(
+            pool, targets.size(), [&]()
+            { return SearchWorkspace<Queue>(hierarchy.get_num_vertices()); },
+            [&](SearchWorkspace<Queue> &workspace, std::size_t column)
+            {
+                upward_search(workspace, target_indices[column], false, [&](Index index, double cost)
+                              { cones[column].emplace_back(index, cost); });
+            });
+
+        std::vector<std::size_t> bucket_offsets(hierarchy.get_num_vertices() + 1, 0);
+        for (const auto &cone : cones)
+        {
+            for (const auto &entry : cone)
+                bucket_offsets[entry.first + 1]++;
+        }
+        for (std::size_t i = 1; i < bucket_offsets.size(); i++)
+            bucket_offsets[i] += bucket_offsets[i - 1];
+        std::vector<std::pair<std::size_t, double>> buckets(bucket_offsets.back());
+        std::vector<std::size_t> next(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (std::size_t column = 0; column < cones.size(); column++)
+        {
+            for (const auto &entry : cones[column])
+                buckets[next[entry.first]++] = std::make_pair(column, entry.second);
+            std::vector<std::pair<Index, double>>().swap(cones[column]);
+        }
+
+        // Forward cones of the sources scan the buckets
+        parallel::for_each_index(
+            pool, sources.size(), [&]()
+            { return SearchWorkspace<Queue>(hierarchy.get_num_vertices()); },
+            [&](SearchWorkspace<Queue> &workspace, std::size_t row)
+            {
+                double *costs = &matrix.costs[row * targets.size()];
+                upward_search(workspace, source_indices[row], true, [&](Index index, double cost)
+                              {
+                    for (std::size_t entry = bucket_offsets[index]; entry < bucket_offsets[index + 1]; entry++)
+                        costs[buckets[entry].first] = std::min(costs[buckets[entry].first], cost + buckets[entry].second); });
+            });
+        return matrix;
+    }
+
+    template <class Queue = QuadHeap, class T>
+    DistanceMatrix distance_matrix(Graph<T> &graph, const std::vector<unsigned int> &sources, const std::vector<unsigned int> &targets,
+                                   parallel::ThreadPool &pool, bool with_predecessors = false)
+    {
+        // The searches read the costs stored in the CSR, not a pinned version of dynamic costs
+        if (graph.get_dynamic_costs())
+            throw std::runtime_error("Distance matrices do not support dynamic edge costs");
+        return distance_matrix<Queue>(graph.get_csr(), sources, targets, pool, with_predecessors);
+    }
+} // namespace algorithm
+
+#endif // DISTANCE_MATRIX_H
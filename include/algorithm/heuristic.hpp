@@ -0,0 +1,126 @@
+#ifndef HEURISTIC_H
+#define HEURISTIC_H
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include "../graph/csr_graph.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Lower-bound estimates used by the A* variants. A heuristic provides
+    //   estimate(from_index, to_index)  estimated cost of the cheapest path between two vertices
+    // and may provide
+    //   estimate_batch(from_indices, count, to_index, estimates)  the same for several vertices at once
+    // Euclidean distance is the default; see landmarks.hpp for the landmark (ALT) bound.
+    template <class T>
+    class EuclideanHeuristic
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+
+        explicit EuclideanHeuristic(const CSRGraph<T> &csr);
+        double estimate(Index from_index, Index to_index) const;
+        void estimate_batch(const Index *from_indices, std::size_t count, Index to_index, double *estimates) const;
+
+    private:
+        const CSRGraph<T> &csr;
+    };
+
+    template <class T>
+    inline EuclideanHeuristic<T>::EuclideanHeuristic(const CSRGraph<T> &csr) : csr(csr) {}
+
+    template <class T>
+    inline double EuclideanHeuristic<T>::estimate(Index from_index, Index to_index) const
+    {
+        return csr.get_heuristic(from_index, to_index);
+    }
+
+    template <class T>
+    inline void EuclideanHeuristic<T>::estimate_batch(const Index *from_indices, std::size_t count, Index to_index, double *estimates) const
+    {
+        std::size_t i = 0;
+        if constexpr (std::is_same_v<T, double>)
+        {
+#if defined(__AVX2__)
+            // Four vertices per step, coordinates gathered straight from the x and y arrays
+            const double *xs = csr.get_x_data();
+            const double *ys = csr.get_y_data();
+            const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            const __m256d goal_x = _mm256_set1_pd(xs[to_index]);
+            const __m256d goal_y = _mm256_set1_pd(ys[to_index]);
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from_indices + i));
+                __m256d x = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), xs, indices, all_lanes, 8);
+                __m256d y = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), ys, indices, all_lanes, 8);
+                __m256d dx = _mm256_sub_pd(x, goal_x);
+                __m256d dy = _mm256_sub_pd(y, goal_y);
+                __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+                _mm256_storeu_pd(estimates + i, _mm256_sqrt_pd(squared));
+            }
+#elif defined(__SSE2__)
+            // Two vertices per step, SSE2 has no gather so the coordinates are loaded one by one
+            const double *xs = csr.get_x_data();
+            const double *ys = csr.get_y_data();
+            const __m128d goal_x = _mm_set1_pd(xs[to_index]);
+            const __m128d goal_y = _mm_set1_pd(ys[to_index]);
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128d dx = _mm_sub_pd(_mm_set_pd(xs[from_indices[i + 1]], xs[from_indices[i]]), goal_x);
+                __m128d dy = _mm_sub_pd(_mm_set_pd(ys[from_indices[i + 1]], ys[from_indices[i]]), goal_y);
+                __m128d squared = _mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy));
+                _mm_storeu_pd(estimates + i, _mm_sqrt_pd(squared));
+            }
+#endif
+        }
+        // Scalar fallback and remainder
+        for (; i < count; i++)
+            estimates[i] = csr.get_heuristic(from_indices[i], to_index);
+    }
+
+    // No estimate at all, turns the A* variants into Dijkstra. Always a valid bound, including for
+    // costs below the straight-line length of their edges.
+    template <class T>
+    class ZeroHeuristic
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+
+        ZeroHeuristic() = default;
+        explicit ZeroHeuristic(const CSRGraph<T> &) {}
+        double estimate(Index, Index) const { return 0; }
+    };
+
+    // Estimate several vertices at once, through the heuristic's own batch routine when it has one
+    template <class Heuristic, class Index>
+    inline void estimate_batch(const Heuristic &heuristic, const Index *from_indices, std::size_t count, Index to_index, double *estimates)
+    {
+        if constexpr (requires { heuristic.estimate_batch(from_indices, count, to_index, estimates); })
+            heuristic.estimate_batch(from_indices, count, to_index, estimates);
+        else
+        {
+            for (std::size_t i = 0; i < count; i++)
+                estimates[i] = heuristic.estimate(from_indices[i], to_index);
+        }
+    }
+
+    template <class T>
+    class LandmarkTable;
+
+    // Landmark tables hold exact costs of the CSR they were computed on, so they stop being lower
+    // bounds once dynamic costs change; the Graph entry points reject them on such graphs
+    template <class Heuristic>
+    inline constexpr bool is_landmark_heuristic = false;
+
+    template <class T>
+    inline constexpr bool is_landmark_heuristic<LandmarkTable<T>> = true;
+} // namespace algorithm
+
+#endif // HEURISTIC_H
@@ -0,0 +1,473 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <vector>
+#include <limits>
+#include <climits>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+#include <memory>
+#include "../graph/csr_graph.hpp"
+#include "../graph/dynamic_costs.hpp"
+#include "../parallel/thread_pool.hpp"
+#include "heuristic.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Lifelong Planning A* (LPA*) for a standing start/goal query over edge costs that change. Each
+    // vertex keeps its cost from the start (g) and a one-step lookahead of it (rhs); after a batch of
+    // cost changes only the vertices whose lookahead changed are re-expanded, so a repair touches the
+    // affected region instead of redoing the whole search. State is kept sparsely for the vertices the
+    // search has reached, which lets thousands of planners share one graph.
+    //
+    // Costs are compared together with the number of edges that reach them, so zero-cost cycles cannot
+    // keep each other alive after the way into them gets more expensive. The heuristic must stay a
+    // consistent lower bound under the updated costs. The Euclidean default assumes no cost drops below
+    // the straight-line length of its edge; use ZeroHeuristic when it may.
+    template <class T, class Heuristic = EuclideanHeuristic<T>>
+    class IncrementalPlanner
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+
+        IncrementalPlanner(const DynamicCosts<T> &costs, unsigned int start_position, unsigned int goal_position);
+        IncrementalPlanner(const DynamicCosts<T> &costs, unsigned int start_position, unsigned int goal_position, Heuristic heuristic);
+
+        // Repair the search after the changes that produced the snapshot's cost version
+        void update(const std::vector<EdgeCostChange> &changes, const CostSnapshot &snapshot);
+
+        unsigned int get_start_position() const;
+        unsigned int get_goal_position() const;
+
+        // Current shortest path as vertex positions, empty if the goal is unreachable or is the start
+        const std::vector<unsigned int> &get_path() const;
+        double get_path_cost() const;
+
+        // Vertices expanded by the last search or repair, and vertices holding search state
+        std::size_t get_num_expanded() const;
+        std::size_t get_num_states() const;
+
+    private:
+        static constexpr double INFINITE_COST = std::numeric_limits<double>::infinity();
+
+        // Cost from the start, ties broken by the number of edges
+        struct Label
+        {
+            double cost;
+            unsigned int hops;
+
+            bool operator<(const Label &other) const;
+            bool operator==(const Label &other) const;
+            bool operator!=(const Label &other) const;
+        };
+
+        struct State
+        {
+            Label g;
+            Label rhs;
+            double estimate;
+            Index parent;
+        };
+
+        // Queue entries are never updated in place, an entry is stale once its vertex is consistent
+        // or its key no longer matches the vertex state
+        struct Entry
+        {
+            Label primary; // min(g, rhs) plus the estimate
+            double secondary; // min(g, rhs)
+            Index index;
+
+            bool operator>(const Entry &other) const;
+        };
+
+        static constexpr Label UNREACHED{INFINITE_COST, UINT_MAX};
+
+        CSRGraph<T> csr; // Shares the arrays of the layer's CSR, the planner does not keep the layer alive
+        const CostSnapshot *costs; // The version being searched, only set while a search runs
+        Heuristic heuristic;
+        Index start_index;
+        Index goal_index;
+        std::unordered_map<Index, State> states;
+        std::vector<Entry> open_set;
+        std::vector<unsigned int> path;
+        std::size_t num_expanded;
+
+        double get_edge_cost(EdgeIndex edge) const;
+        static Label extend(const Label &label, double cost);
+        State &get_state(Index index);
+        const State *find_state(Index index) const;
+        Entry make_entry(Index index, const State &state) const;
+        bool is_stale(const Entry &entry) const;
+        void enqueue(Index index);
+        void recompute_rhs(Index index);
+        void compute_shortest_path();
+        void extract_path();
+    };
+
+    // Keeps many standing routes repaired against one shared, changing cost layer, which stays alive for
+    // as long as the routes do. The routes only learn about the changes made through update_costs, so
+    // other writers must not update the same layer.
+    template <class T, class Heuristic = EuclideanHeuristic<T>>
+    class StandingRoutes
+    {
+    public:
+        using Planner = IncrementalPlanner<T, Heuristic>;
+
+        explicit StandingRoutes(std::shared_ptr<DynamicCosts<T>> costs);
+
+        // Add a route and search it, returns its id
+        std::size_t add_route(unsigned int start_position, unsigned int goal_position);
+        std::size_t get_num_routes() const;
+        const Planner &get_route(std::size_t route) const;
+
+        // Apply a batch of cost updates and repair every route, on the pool's threads when one is given.
+        // Returns the number of edges whose cost changed.
+        std::size_t update_costs(const std::vector<EdgeCostUpdate> &updates, parallel::ThreadPool *pool = nullptr);
+
+    private:
+        std::shared_ptr<DynamicCosts<T>> costs;
+        std::vector<Planner> routes;
+    };
+
+    template <class T, class Heuristic>
+    inline bool IncrementalPlanner<T, Heuristic>::Label::operator<(const Label &other) const
+    {
+        return cost < other.cost || (cost == other.cost && hops < other.hops);
+    }
+
+    template <class T, class Heuristic>
+    inline bool IncrementalPlanner<T, Heuristic>::Label::operator==(const Label &other) const
+    {
+        return cost == other.cost && hops == other.hops;
+    }
+
+    template <class T, class Heuristic>
+    inline bool IncrementalPlanner<T, Heuristic>::Label::operator!=(const Label &other) const
+    {
+        return !(*this == other);
+    }
+
+    template <class T, class Heuristic>
+    inline bool IncrementalPlanner<T, Heuristic>::Entry::operator>(const Entry &other) const
+    {
+        return other.primary < primary || (primary == other.primary && secondary > other.secondary);
+    }
+
+    template <class T, class Heuristic>
+    inline IncrementalPlanner<T, Heuristic>::IncrementalPlanner(const DynamicCosts<T> &costs, unsigned int start_position, unsigned int goal_position)
+        : IncrementalPlanner(costs, start_position, goal_position, Heuristic(costs.get_csr())) {}
+
+    template <class T, class Heuristic>
+    inline IncrementalPlanner<T, Heuristic>::IncrementalPlanner(const DynamicCosts<T> &costs, unsigned int start_position, unsigned int goal_position,
+                                                                Heuristic heuristic)
+        : csr(costs.get_csr()), costs(nullptr), heuristic(std::move(heuristic)), start_index(csr.get_index(start_position)),
+          goal_index(csr.get_index(goal_position)), num_expanded(0)
+    {
+        const CostSnapshot snapshot = costs.pin();
+        this->costs = &snapshot;
+        get_state(start_index).rhs = Label{0, 0};
+        enqueue(start_index);
+        compute_shortest_path();
+        extract_path();
+        this->costs = nullptr;
+    }
+
+    template <class T, class Heuristic>
+    inline void IncrementalPlanner<T, Heuristic>::update(const std::vector<EdgeCostChange> &changes, const CostSnapshot &snapshot)
+    {
+        costs = &snapshot;
+        bool affected = false;
+        for (const auto &change : changes)
+        {
+            // The lookahead of the target only depends on the edge when the source has been reached
+            const State *source = find_state(change.source);
+            if (change.target == start_index || change.source == change.target || !source || source->g == UNREACHED)
+                continue;
+            affected = true;
+
+            State &target = get_state(change.target);
+            double old_cost = change.old_cost == -1 ? INFINITE_COST : change.old_cost;
+            double new_cost = get_edge_cost(change.edge); // Later changes of the batch may have replaced it
+            if (new_cost < old_cost)
+            {
+                Label label = extend(source->g, new_cost);
+                if (label < target.rhs)
+                {
+                    target.rhs = label;
+                    target.parent = change.source;
+                }
+            }
+            else if (target.parent == change.source)
+                recompute_rhs(change.target);
+            enqueue(change.target);
+        }
+
+        num_expanded = 0;
+        if (affected)
+        {
+            compute_shortest_path();
+            extract_path();
+        }
+        costs = nullptr;
+    }
+
+    template <class T, class Heuristic>
+    inline unsigned int IncrementalPlanner<T, Heuristic>::get_start_position() const
+    {
+        return csr.get_position(start_index);
+    }
+
+    template <class T, class Heuristic>
+    inline unsigned int IncrementalPlanner<T, Heuristic>::get_goal_position() const
+    {
+        return csr.get_position(goal_index);
+    }
+
+    template <class T, class Heuristic>
+    inline const std::vector<unsigned int> &IncrementalPlanner<T, Heuristic>::get_path() const
+    {
+        return path;
+    }
+
+    template <class T, class Heuristic>
+    inline double IncrementalPlanner<T, Heuristic>::get_path_cost() const
+    {
+        const State *goal = find_state(goal_index);
+        return goal ? goal->g.cost : INFINITE_COST;
+    }
+
+    template <class T, class Heuristic>
+    inline std::size_t IncrementalPlanner<T, Heuristic>::get_num_expanded() const
+    {
+        return num_expanded;
+    }
+
+    template <class T, class Heuristic>
+    inline std::size_t IncrementalPlanner<T, Heuristic>::get_num_states() const
+    {
+        return states.size();
+    }
+
+    template <class T, class Heuristic>
+    inline double IncrementalPlanner<T, Heuristic>::get_edge_cost(EdgeIndex edge) const
+    {
+        double cost = costs->get_cost(edge);
+        return cost == -1 ? INFINITE_COST : cost;
+    }
+
+    template <class T, class Heuristic>
+    inline typename IncrementalPlanner<T, Heuristic>::Label IncrementalPlanner<T, Heuristic>::extend(const Label &label, double cost)
+    {
+        if (label.cost == INFINITE_COST || cost == INFINITE_COST)
+            return UNREACHED;
+        return Label{label.cost + cost, label.hops + 1};
+    }
+
+    template <class T, class Heuristic>
+    inline typename IncrementalPlanner<T, Heuristic>::State &IncrementalPlanner<T, Heuristic>::get_state(Index index)
+    {
+        auto it = states.find(index);
+        if (it == states.end())
+            it = states.emplace(index, State{UNREACHED, UNREACHED, heuristic.estimate(index, goal_index), CSRGraph<T>::INVALID_INDEX}).first;
+        return it->second;
+    }
+
+    template <class T, class Heuristic>
+    inline const typename IncrementalPlanner<T, Heuristic>::State *IncrementalPlanner<T, Heuristic>::find_state(Index index) const
+    {
+        auto it = states.find(index);
+        return it == states.end() ? nullptr : &it->second;
+    }
+
+    template <class T, class Heuristic>
+    inline typename IncrementalPlanner<T, Heuristic>::Entry IncrementalPlanner<T, Heuristic>::make_entry(Index index, const State &state) const
+    {
+        Label label = std::min(state.g, state.rhs);
+        return Entry{Label{label.cost + state.estimate, label.hops}, label.cost, index};
+    }
+
+    template <class T, class Heuristic>
+    inline bool IncrementalPlanner<T, Heuristic>::is_stale(const Entry &entry) const
+    {
+        const State &state = states.find(entry.index)->second;
+        if (state.g == state.rhs)
+            return true;
+        Entry current = make_entry(entry.index, state);
+        return current.primary != entry.primary || current.secondary != entry.secondary;
+    }
+
+    template <class T, class Heuristic>
+    inline void IncrementalPlanner<T, Heuristic>::enqueue(Index index)
+    {
+        const State &state = get_state(index);
+        if (state.g != state.rhs)
+        {
+            open_set.push_back(make_entry(index, state));
+            std::push_heap(open_set.begin(), open_set.end(), std::greater<Entry>());
+        }
+    }
+
+    template <class T, class Heuristic>
+    inline void IncrementalPlanner<T, Heuristic>::recompute_rhs(Index index)
+    {
+        // Cheapest way in through an already reached predecessor
+        State &state = get_state(index);
+        state.rhs = UNREACHED;
+        state.parent = CSRGraph<T>::INVALID_INDEX;
+        for (auto in_edge = csr.in_edges_begin(index); in_edge != csr.in_edges_end(index); in_edge++)
+        {
+            Index source = csr.get_source(in_edge);
+            const State *predecessor = find_state(source);
+            if (!predecessor || source == index)
+                continue;
+            Label label = extend(predecessor->g, get_edge_cost(csr.get_forward_edge(in_edge)));
+            if (label < state.rhs)
+            {
+                state.rhs = label;
+                state.parent = source;
+            }
+        }
+    }
+
+    template <class T, class Heuristic>
+    inline void IncrementalPlanner<T, Heuristic>::compute_shortest_path()
+    {
+        while (true)
+        {
+            while (!open_set.empty() && is_stale(open_set.front()))
+            {
+                std::pop_heap(open_set.begin(), open_set.end(), std::greater<Entry>());
+                open_set.pop_back();
+            }
+            if (open_set.empty())
+                break;
+
+            // Stop once the goal is consistent and nothing cheaper than it is left to expand
+            const State &goal = get_state(goal_index);
+            if (goal.g == goal.rhs && !(make_entry(goal_index, goal) > open_set.front()))
+                break;
+
+            Index current_index = open_set.front().index;
+            std::pop_heap(open_set.begin(), open_set.end(), std::greater<Entry>());
+            open_set.pop_back();
+            num_expanded++;
+
+            State &current = get_state(current_index);
+            if (current.rhs < current.g)
+            {
+                // Overconsistent: settle the vertex and offer it to its successors
+                current.g = current.rhs;
+                for (auto edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+                {
+                    Index neighbor_index = csr.get_target(edge);
+                    if (neighbor_index == start_index || neighbor_index == current_index)
+                        continue;
+                    State &neighbor = get_state(neighbor_index);
+                    Label label = extend(current.g, get_edge_cost(edge));
+                    if (label < neighbor.rhs)
+                    {
+                        neighbor.rhs = label;
+                        neighbor.parent = current_index;
+                        enqueue(neighbor_index);
+                    }
+                }
+            }
+            else
+            {
+                // Underconsistent: the vertex got more expensive, so it and every successor that
+                // relied on it look for a new way in
+                current.g = UNREACHED;
+                if (current_index != start_index)
+                    recompute_rhs(current_index);
+                enqueue(current_index);
+                for (auto edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+                {
+                    Index neighbor_index = csr.get_target(edge);
+                    const State *neighbor = find_state(neighbor_index);
+                    if (neighbor_index != start_index && neighbor && neighbor->parent == current_index)
+                    {
+                        recompute_rhs(neighbor_index);
+                        enqueue(neighbor_index);
+                    }
+                }
+            }
+        }
+    }
+
+    template <class T, class Heuristic>
+    inline void IncrementalPlanner<T, Heuristic>::extract_path()
+    {
+        path.clear();
+        const State *goal = find_state(goal_index);
+        if (start_index == goal_index || !goal || goal->g == UNREACHED)
+            return;
+
+        // Walk the parents back from the goal, every vertex on the way is consistent
+        for (Index index = goal_index; index != start_index; index = states.find(index)->second.parent)
+        {
+            if (path.size() > states.size() || index == CSRGraph<T>::INVALID_INDEX)
+                throw std::runtime_error("Incremental search left a broken parent chain");
+            path.push_back(csr.get_position(index));
+        }
+        path.push_back(csr.get_position(start_index));
+        std::reverse(path.begin(), path.end());
+    }
+
+    template <class T, class Heuristic>
+    inline StandingRoutes<T, Heuristic>::StandingRoutes(std::shared_ptr<DynamicCosts<T>> costs) : costs(std::move(costs))
+    {
+        if (!this->costs)
+            throw std::invalid_argument("Standing routes need a cost layer");
+    }
+
+    template <class T, class Heuristic>
+    inline std::size_t StandingRoutes<T, Heuristic>::add_route(unsigned int start_position, unsigned int goal_position)
+    {
+        routes.emplace_back(*costs, start_position, goal_position);
+        return routes.size() - 1;
+    }
+
+    template <class T, class Heuristic>
+    inline std::size_t StandingRoutes<T, Heuristic>::get_num_routes() const
+    {
+        return routes.size();
+    }
+
+    template <class T, class Heuristic>
+    inline const typename StandingRoutes<T, Heuristic>::Planner &StandingRoutes<T, Heuristic>::get_route(std::size_t route) const
+    {
+        if (route >= routes.size())
+            throw std::out_of_range("Route not found");
+        return routes[route];
+    }
+
+    template <class T, class Heuristic>
+    inline std::size_t StandingRoutes<T, Heuristic>::update_costs(const std::vector<EdgeCostUpdate> &updates, parallel::ThreadPool *pool)
+    {
+        // Every route repairs against the version this batch published, even if other writers have
+        // published newer ones since
+        CostSnapshot snapshot;
+        const std::vector<EdgeCostChange> changes = costs->update_costs(updates, &snapshot);
+        if (changes.empty())
+            return 0;
+        if (pool)
+        {
+            auto no_state = []()
+            { return 0; };
+            parallel::for_each_index(*pool, routes.size(), no_state, [&](int &, std::size_t route)
+                                     { routes[route].update(changes, snapshot); });
+        }
+        else
+        {
+            for (auto &route : routes)
+                route.update(changes, snapshot);
+        }
+        return changes.size();
+    }
+} // namespace algorithm
+
+#endif // INCREMENTAL_H
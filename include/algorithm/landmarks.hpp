@@ -0,0 +1,361 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <cstring>
+#include <stdexcept>
+#include "../graph/csr_graph.hpp"
+#include "workspace.hpp"
+#include "dijkstra.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // How the landmarks are chosen
+    enum class LandmarkSelection
+    {
+        FARTHEST, // Each new landmark is the vertex farthest from the ones already chosen
+        AVOID     // Each new landmark is a leaf of the shortest path tree region the current bounds cover worst
+    };
+
+    // Landmark (ALT) lower bounds. For each landmark L the exact costs d(L, v) and d(v, L) of every vertex
+    // are precomputed, and the triangle inequality gives
+    //   d(u, v) >= max(d(L, v) - d(L, u), d(u, L) - d(v, L))
+    // The bound is consistent, so A* and bidirectional A* stay exact with it whatever the edge costs mean.
+    // Both tables are stored vertex-major (all landmarks of a vertex are adjacent) so one estimate reads
+    // two contiguous runs of K values per table.
+    template <class T>
+    class LandmarkTable
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+
+        LandmarkTable();
+        LandmarkTable(const CSRGraph<T> &csr, unsigned int num_landmarks, LandmarkSelection selection = LandmarkSelection::AVOID);
+
+        std::size_t get_num_landmarks() const;
+        std::size_t get_num_vertices() const;
+        Index get_landmark(std::size_t k) const;
+        double estimate(Index from_index, Index to_index) const;
+
+        // Binary serialization, the file is tied to the graph it was computed on
+        void save(const std::string &filename, const CSRGraph<T> &csr) const;
+        void save(std::ostream &stream, const CSRGraph<T> &csr) const;
+        static LandmarkTable load(const std::string &filename, const CSRGraph<T> &csr);
+        static LandmarkTable load(std::istream &stream, const CSRGraph<T> &csr, const std::string &name);
+
+    private:
+        static constexpr char MAGIC[8] = {'P', 'F', 'L', 'M', 'A', 'R', 'K', 'S'};
+        static constexpr std::uint32_t VERSION = 1;
+
+        std::vector<Index> landmarks;
+        std::size_t num_vertices;
+        std::vector<double> from_landmark; // [v * K + k] = d(landmark k, v)
+        std::vector<double> to_landmark;   // [v * K + k] = d(v, landmark k)
+
+        void add_landmarks(const CSRGraph<T> &csr, const std::vector<Index> &chosen, SearchWorkspace<> &workspace);
+        Index select_farthest(const CSRGraph<T> &csr, Index root, SearchWorkspace<> &workspace) const;
+        Index select_avoid(const CSRGraph<T> &csr, Index root, SearchWorkspace<> &workspace) const;
+    };
+
+    template <class T>
+    inline LandmarkTable<T>::LandmarkTable() : num_vertices(0) {}
+
+    template <class T>
+    inline LandmarkTable<T>::LandmarkTable(const CSRGraph<T> &csr, unsigned int num_landmarks, LandmarkSelection selection)
+        : num_vertices(csr.get_num_vertices())
+    {
+        if (csr.is_empty())
+            return;
+        SearchWorkspace<> workspace(num_vertices);
+        std::mt19937 rng(num_vertices);
+        std::uniform_int_distribution<Index> random_vertex(0, num_vertices - 1);
+        num_landmarks = std::min<std::size_t>(num_landmarks, num_vertices);
+
+        while (landmarks.size() < num_landmarks)
+        {
+            Index root = random_vertex(rng);
+            Index landmark = (selection == LandmarkSelection::AVOID && !landmarks.empty())
+                                 ? select_avoid(csr, root, workspace)
+                                 : select_farthest(csr, root, workspace);
+            if (std::find(landmarks.begin(), landmarks.end(), landmark) != landmarks.end())
+                landmark = select_farthest(csr, root, workspace);
+            if (std::find(landmarks.begin(), landmarks.end(), landmark) != landmarks.end())
+                break; // Every candidate is already a landmark
+            add_landmarks(csr, std::vector<Index>{landmark}, workspace);
+        }
+    }
+
+    template <class T>
+    inline void LandmarkTable<T>::add_landmarks(const CSRGraph<T> &csr, const std::vector<Index> &chosen, SearchWorkspace<> &workspace)
+    {
+        // Widen the vertex-major tables by the new landmarks
+        const std::size_t old_count = landmarks.size();
+        const std::size_t new_count = old_count + chosen.size();
+        std::vector<double> from_table(num_vertices * new_count), to_table(num_vertices * new_count);
+        for (std::size_t v = 0; v < num_vertices; v++)
+        {
+            for (std::size_t k = 0; k < old_count; k++)
+            {
+                from_table[v * new_count + k] = from_landmark[v * old_count + k];
+                to_table[v * new_count + k] = to_landmark[v * old_count + k];
+            }
+        }
+
+        for (std::size_t k = old_count; k < new_count; k++)
+        {
+            DijkstraQuery query;
+            run_dijkstra(csr, csr.get_position(chosen[k - old_count]), query, workspace);
+            for (std::size_t v = 0; v < num_vertices; v++)
+                from_table[v * new_count + k] = workspace.get_cost(v);
+
+            query.reverse = true;
+            run_dijkstra(csr, csr.get_position(chosen[k - old_count]), query, workspace);
+            for (std::size_t v = 0; v < num_vertices; v++)
+                to_table[v * new_count + k] = workspace.get_cost(v);
+        }
+
+        landmarks.insert(landmarks.end(), chosen.begin(), chosen.end());
+        from_landmark.swap(from_table);
+        to_landmark.swap(to_table);
+    }
+
+    template <class T>
+    inline typename LandmarkTable<T>::Index LandmarkTable<T>::select_farthest(const CSRGraph<T> &csr, Index root, SearchWorkspace<> &workspace) const
+    {
+        const std::size_t count = landmarks.size();
+        const double infinity = std::numeric_limits<double>::infinity();
+        Index best_index = root;
+        double best_distance = -1;
+
+        if (count == 0)
+        {
+            // Farthest vertex reachable from the root
+            run_dijkstra(csr, csr.get_position(root), DijkstraQuery(), workspace);
+            for (Index v = 0; v < num_vertices; v++)
+            {
+                if (workspace.is_reached(v) && workspace.get_cost(v) > best_distance)
+                {
+                    best_distance = workspace.get_cost(v);
+                    best_index = v;
+                }
+            }
+            return best_index;
+        }
+
+        // Vertex whose round trip to the closest landmark is largest, vertices no landmark reaches come first
+        for (Index v = 0; v < num_vertices; v++)
+        {
+            double closest = infinity;
+            for (std::size_t k = 0; k < count; k++)
+                closest = std::min(closest, from_landmark[v * count + k] + to_landmark[v * count + k]);
+            if (closest > best_distance && std::find(landmarks.begin(), landmarks.end(), v) == landmarks.end())
+            {
+                best_distance = closest;
+                best_index = v;
+            }
+        }
+        return best_index;
+    }
+
+    template <class T>
+    inline typename LandmarkTable<T>::Index LandmarkTable<T>::select_avoid(const CSRGraph<T> &csr, Index root, SearchWorkspace<> &workspace) const
+    {
+        // Shortest path tree from the root, children stored in CSR form
+        run_dijkstra(csr, csr.get_position(root), DijkstraQuery(), workspace);
+        std::vector<std::size_t> child_offsets(num_vertices + 1, 0);
+        for (Index v = 0; v < num_vertices; v++)
+        {
+            if (workspace.is_reached(v) && v != root)
+                child_offsets[workspace.get_previous(v) + 1]++;
+        }
+        for (std::size_t i = 1; i < child_offsets.size(); i++)
+            child_offsets[i] += child_offsets[i - 1];
+        std::vector<Index> children(child_offsets.back());
+        std::vector<std::size_t> next(child_offsets.begin(), child_offsets.end() - 1);
+        for (Index v = 0; v < num_vertices; v++)
+        {
+            if (workspace.is_reached(v) && v != root)
+                children[next[workspace.get_previous(v)]++] = v;
+        }
+
+        // Post-order pass: a vertex weighs how much the current bound underestimates its distance, and a
+        // subtree that already contains a landmark weighs nothing
+        std::vector<double> sizes(num_vertices, 0);
+        std::vector<bool> has_landmark(num_vertices, false);
+        for (auto landmark : landmarks)
+            has_landmark[landmark] = true;
+        std::vector<std::pair<Index, bool>> stack{{root, false}};
+        while (!stack.empty())
+        {
+            auto entry = stack.back();
+            stack.pop_back();
+            Index v = entry.first;
+            if (!entry.second)
+            {
+                stack.emplace_back(v, true);
+                for (std::size_t c = child_offsets[v]; c < child_offsets[v + 1]; c++)
+                    stack.emplace_back(children[c], false);
+                continue;
+            }
+            double size = workspace.get_cost(v) - estimate(root, v);
+            for (std::size_t c = child_offsets[v]; c < child_offsets[v + 1]; c++)
+            {
+                size += sizes[children[c]];
+                has_landmark[v] = has_landmark[v] || has_landmark[children[c]];
+            }
+            sizes[v] = has_landmark[v] ? 0 : size;
+        }
+
+        // Descend along the heaviest child until reaching a leaf
+        Index current = root;
+        while (child_offsets[current] != child_offsets[current + 1])
+        {
+            Index heaviest = children[child_offsets[current]];
+            for (std::size_t c = child_offsets[current]; c < child_offsets[current + 1]; c++)
+            {
+                if (sizes[children[c]] > sizes[heaviest])
+                    heaviest = children[c];
+            }
+            if (sizes[heaviest] <= 0)
+                break;
+            current = heaviest;
+        }
+        return current;
+    }
+
+    template <class T>
+    inline std::size_t LandmarkTable<T>::get_num_landmarks() const
+    {
+        return landmarks.size();
+    }
+
+    template <class T>
+    inline std::size_t LandmarkTable<T>::get_num_vertices() const
+    {
+        return num_vertices;
+    }
+
+    template <class T>
+    inline typename LandmarkTable<T>::Index LandmarkTable<T>::get_landmark(std::size_t k) const
+    {
+        return landmarks[k];
+    }
+
+    template <class T>
+    inline double LandmarkTable<T>::estimate(Index from_index, Index to_index) const
+    {
+        const std::size_t count = landmarks.size();
+        const double infinity = std::numeric_limits<double>::infinity();
+        const double *from_from = &from_landmark[from_index * count];
+        const double *from_to = &from_landmark[to_index * count];
+        const double *to_from = &to_landmark[from_index * count];
+        const double *to_to = &to_landmark[to_index * count];
+
+        // An infinite term is a valid bound (the target is unreachable), unless it would be infinity - infinity
+        double bound = 0;
+        for (std::size_t k = 0; k < count; k++)
+        {
+            if (from_from[k] != infinity)
+                bound = std::max(bound, from_to[k] - from_from[k]);
+            if (to_to[k] != infinity)
+                bound = std::max(bound, to_from[k] - to_to[k]);
+        }
+        return bound;
+    }
+
+    template <class T>
+    inline void LandmarkTable<T>::save(const std::string &filename, const CSRGraph<T> &csr) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error opening file: " + filename);
+        }
+        save(file, csr);
+        if (!file)
+        {
+            throw std::runtime_error("Error writing file: " + filename);
+        }
+    }
+
+    template <class T>
+    inline void LandmarkTable<T>::save(std::ostream &stream, const CSRGraph<T> &csr) const
+    {
+        std::uint32_t version = VERSION;
+        std::uint32_t count = landmarks.size();
+        std::uint64_t vertex_count = num_vertices;
+        std::uint64_t edge_count = csr.get_num_edges();
+        stream.write(MAGIC, sizeof(MAGIC));
+        stream.write(reinterpret_cast<const char *>(&version), sizeof(version));
+        stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        stream.write(reinterpret_cast<const char *>(&vertex_count), sizeof(vertex_count));
+        stream.write(reinterpret_cast<const char *>(&edge_count), sizeof(edge_count));
+        for (auto landmark : landmarks)
+        {
+            std::uint32_t position = csr.get_position(landmark);
+            stream.write(reinterpret_cast<const char *>(&position), sizeof(position));
+        }
+        stream.write(reinterpret_cast<const char *>(from_landmark.data()), from_landmark.size() * sizeof(double));
+        stream.write(reinterpret_cast<const char *>(to_landmark.data()), to_landmark.size() * sizeof(double));
+    }
+
+    template <class T>
+    inline LandmarkTable<T> LandmarkTable<T>::load(const std::string &filename, const CSRGraph<T> &csr)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error opening file: " + filename);
+        }
+        return load(file, csr, filename);
+    }
+
+    template <class T>
+    inline LandmarkTable<T> LandmarkTable<T>::load(std::istream &stream, const CSRGraph<T> &csr, const std::string &name)
+    {
+        char magic[sizeof(MAGIC)];
+        std::uint32_t version, count;
+        std::uint64_t vertex_count, edge_count;
+        stream.read(magic, sizeof(magic));
+        stream.read(reinterpret_cast<char *>(&version), sizeof(version));
+        stream.read(reinterpret_cast<char *>(&count), sizeof(count));
+        stream.read(reinterpret_cast<char *>(&vertex_count), sizeof(vertex_count));
+        stream.read(reinterpret_cast<char *>(&edge_count), sizeof(edge_count));
+        if (!stream || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION)
+        {
+            throw std::runtime_error("Not a landmark file: " + name);
+        }
+        if (vertex_count != csr.get_num_vertices() || edge_count != csr.get_num_edges())
+        {
+            throw std::runtime_error("Landmark file does not match the graph: " + name);
+        }
+
+        LandmarkTable table;
+        table.num_vertices = vertex_count;
+        for (std::uint32_t k = 0; k < count; k++)
+        {
+            std::uint32_t position;
+            stream.read(reinterpret_cast<char *>(&position), sizeof(position));
+            table.landmarks.push_back(csr.get_index(position));
+        }
+        table.from_landmark.resize(vertex_count * count);
+        table.to_landmark.resize(vertex_count * count);
+        stream.read(reinterpret_cast<char *>(table.from_landmark.data()), table.from_landmark.size() * sizeof(double));
+        stream.read(reinterpret_cast<char *>(table.to_landmark.data()), table.to_landmark.size() * sizeof(double));
+        if (!stream)
+        {
+            throw std::runtime_error("Truncated landmark file: " + name);
+        }
+        return table;
+    }
+} // namespace algorithm
+
+#endif // LANDMARKS_H
@@ -0,0 +1,61 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "../graph/csr_graph.hpp"
+#include "workspace.hpp"
+
+using namespace graph;
+
+namespace algorithm
+{
+    // Walk the workspace predecessors back from the end index and return the path as vertex positions.
+    // An empty path is returned if the end was never reached or coincides with the start.
+    template <class T, class Workspace>
+    std::vector<unsigned int> reconstruct_path(const CSRGraph<T> &csr, const Workspace &workspace,
+                                               typename CSRGraph<T>::Index start_index, typename CSRGraph<T>::Index end_index)
+    {
+        if (start_index == end_index || workspace.get_previous(end_index) == CSRGraph<T>::INVALID_INDEX)
+            return std::vector<unsigned int>();
+
+        // Count the vertices first so the path is allocated once and filled from the back
+        std::size_t length = 1;
+        for (auto index = end_index; index != CSRGraph<T>::INVALID_INDEX && index != start_index; index = workspace.get_previous(index))
+            length++;
+
+        std::vector<unsigned int> path(length);
+        auto current_index = end_index;
+        while (current_index != CSRGraph<T>::INVALID_INDEX && current_index != start_index)
+        {
+            path[--length] = csr.get_position(current_index);
+            current_index = workspace.get_previous(current_index);
+        }
+        path[0] = csr.get_position(start_index);
+        return path;
+    }
+
+    // Cost of a path given as vertex positions, taking the cheapest traversable edge between consecutive
+    // vertices. Infinity is returned if two consecutive vertices are not connected.
+    template <class T>
+    double path_cost(const CSRGraph<T> &csr, const std::vector<unsigned int> &path)
+    {
+        double cost = 0;
+        for (std::size_t i = 0; i + 1 < path.size(); i++)
+        {
+            auto from_index = csr.get_index(path[i]);
+            auto to_index = csr.get_index(path[i + 1]);
+            double cheapest = std::numeric_limits<double>::infinity();
+            for (auto edge = csr.edges_begin(from_index); edge != csr.edges_end(from_index); edge++)
+            {
+                if (csr.get_target(edge) == to_index && csr.get_cost(edge) != -1)
+                    cheapest = std::min(cheapest, csr.get_cost(edge));
+            }
+            cost += cheapest;
+        }
+        return cost;
+    }
+} // namespace algorithm
+
+#endif // PATH_H
@@ -0,0 +1,531 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <vector>
+#include <array>
+#include <limits>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+namespace algorithm
+{
+    // Addressable min-priority queues keyed by dense vertex index. Every policy offers the same
+    // interface so the search algorithms can take the queue as a template parameter:
+    //   reserve(n)        size the per-vertex bookkeeping for indices 0..n-1
+    //   clear()           drop all queued vertices
+    //   push(index, key)  insert the vertex, or decrease its key if it is already queued
+    //   top_key()         smallest key currently queued
+    //   pop()             remove and return the vertex with the smallest key
+    // A vertex is in the queue at most once, so a pop never returns a stale entry.
+
+    // Indexed d-ary heap with true decrease-key.
+    template <unsigned int Arity, class Key = double>
+    class DaryHeap
+    {
+    public:
+        using Index = unsigned int;
+        using KeyType = Key;
+
+        void reserve(std::size_t num_vertices);
+        void clear();
+        bool empty() const;
+        std::size_t size() const;
+        bool contains(Index index) const;
+        const Key &top_key() const;
+        Index top() const;
+        const Key &get_key(Index index) const;
+        void push(Index index, const Key &key);
+        Index pop();
+        void remove(Index index);
+
+    private:
+        static constexpr unsigned int NOT_QUEUED = UINT_MAX;
+
+        std::vector<std::pair<Key, Index>> heap;
+        std::vector<unsigned int> slots;
+
+        void sift_up(unsigned int slot);
+        void sift_down(unsigned int slot);
+        void place(unsigned int slot, std::pair<Key, Index> entry);
+    };
+
+    using QuadHeap = DaryHeap<4>;
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::reserve(std::size_t num_vertices)
+    {
+        if (num_vertices > slots.size())
+            slots.resize(num_vertices, NOT_QUEUED);
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::clear()
+    {
+        for (const auto &entry : heap)
+            slots[entry.second] = NOT_QUEUED;
+        heap.clear();
+    }
+
+    template <unsigned int Arity, class Key>
+    inline bool DaryHeap<Arity, Key>::empty() const
+    {
+        return heap.empty();
+    }
+
+    template <unsigned int Arity, class Key>
+    inline std::size_t DaryHeap<Arity, Key>::size() const
+    {
+        return heap.size();
+    }
+
+    template <unsigned int Arity, class Key>
+    inline bool DaryHeap<Arity, Key>::contains(Index index) const
+    {
+        return slots[index] != NOT_QUEUED;
+    }
+
+    template <unsigned int Arity, class Key>
+    inline const Key &DaryHeap<Arity, Key>::top_key() const
+    {
+        return heap.front().first;
+    }
+
+    template <unsigned int Arity, class Key>
+    inline typename DaryHeap<Arity, Key>::Index DaryHeap<Arity, Key>::top() const
+    {
+        return heap.front().second;
+    }
+
+    template <unsigned int Arity, class Key>
+    inline const Key &DaryHeap<Arity, Key>::get_key(Index index) const
+    {
+        return heap[slots[index]].first;
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::push(Index index, const Key &key)
+    {
+        if (slots[index] == NOT_QUEUED)
+        {
+            heap.emplace_back(key, index);
+            slots[index] = heap.size() - 1;
+            sift_up(heap.size() - 1);
+        }
+        else if (key < heap[slots[index]].first)
+        {
+            heap[slots[index]].first = key;
+            sift_up(slots[index]);
+        }
+    }
+
+    template <unsigned int Arity, class Key>
+    inline typename DaryHeap<Arity, Key>::Index DaryHeap<Arity, Key>::pop()
+    {
+        Index index = heap.front().second;
+        remove(index);
+        return index;
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::remove(Index index)
+    {
+        unsigned int slot = slots[index];
+        slots[index] = NOT_QUEUED;
+        auto last = heap.back();
+        heap.pop_back();
+        if (slot == heap.size())
+            return;
+
+        // Move the last entry into the hole and restore the heap order in whichever direction it violates
+        bool smaller = last.first < heap[slot].first;
+        place(slot, last);
+        if (smaller)
+            sift_up(slot);
+        else
+            sift_down(slot);
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::sift_up(unsigned int slot)
+    {
+        auto entry = heap[slot];
+        while (slot > 0)
+        {
+            unsigned int parent = (slot - 1) / Arity;
+            if (!(entry.first < heap[parent].first))
+                break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::sift_down(unsigned int slot)
+    {
+        auto entry = heap[slot];
+        const std::size_t count = heap.size();
+        while (true)
+        {
+            std::size_t first_child = std::size_t(slot) * Arity + 1;
+            if (first_child >= count)
+                break;
+            std::size_t last_child = std::min<std::size_t>(first_child + Arity, count);
+            std::size_t best_child = first_child;
+            for (std::size_t child = first_child + 1; child < last_child; child++)
+            {
+                if (heap[child].first < heap[best_child].first)
+                    best_child = child;
+            }
+            if (!(heap[best_child].first < entry.first))
+                break;
+            place(slot, heap[best_child]);
+            slot = best_child;
+        }
+        place(slot, entry);
+    }
+
+    template <unsigned int Arity, class Key>
+    inline void DaryHeap<Arity, Key>::place(unsigned int slot, std::pair<Key, Index> entry)
+    {
+        heap[slot] = entry;
+        slots[entry.second] = slot;
+    }
+
+    // Pairing heap over a node pool indexed by vertex, decrease-key cuts the subtree and melds it with the root.
+    class PairingHeap
+    {
+    public:
+        using Index = unsigned int;
+        using KeyType = double;
+
+        PairingHeap();
+        void reserve(std::size_t num_vertices);
+        void clear();
+        bool empty() const;
+        std::size_t size() const;
+        bool contains(Index index) const;
+        double top_key() const;
+        Index top() const;
+        void push(Index index, double key);
+        Index pop();
+
+    private:
+        static constexpr Index NIL = UINT_MAX;
+
+        struct Node
+        {
+            double key;
+            Index child;
+            Index sibling;
+            Index prev; // Parent for a leftmost child, left sibling otherwise
+            unsigned int stamp;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<Index> pairs;
+        Index root;
+        std::size_t count;
+        unsigned int generation;
+
+        Index meld(Index a, Index b);
+        void cut(Index index);
+    };
+
+    inline PairingHeap::PairingHeap() : root(NIL), count(0), generation(1) {}
+
+    inline void PairingHeap::reserve(std::size_t num_vertices)
+    {
+        if (num_vertices > nodes.size())
+            nodes.resize(num_vertices, Node{0, NIL, NIL, NIL, 0});
+    }
+
+    inline void PairingHeap::clear()
+    {
+        root = NIL;
+        count = 0;
+        if (++generation == 0)
+        {
+            // The counter wrapped around, old stamps could alias the new generation
+            for (auto &node : nodes)
+                node.stamp = 0;
+            generation = 1;
+        }
+    }
+
+    inline bool PairingHeap::empty() const
+    {
+        return root == NIL;
+    }
+
+    inline std::size_t PairingHeap::size() const
+    {
+        return count;
+    }
+
+    inline bool PairingHeap::contains(Index index) const
+    {
+        return nodes[index].stamp == generation;
+    }
+
+    inline double PairingHeap::top_key() const
+    {
+        return nodes[root].key;
+    }
+
+    inline PairingHeap::Index PairingHeap::top() const
+    {
+        return root;
+    }
+
+    inline void PairingHeap::push(Index index, double key)
+    {
+        Node &node = nodes[index];
+        if (node.stamp != generation)
+        {
+            node = Node{key, NIL, NIL, NIL, generation};
+            root = (root == NIL) ? index : meld(root, index);
+            count++;
+        }
+        else if (key < node.key)
+        {
+            node.key = key;
+            if (index != root)
+            {
+                cut(index);
+                root = meld(root, index);
+            }
+        }
+    }
+
+    inline PairingHeap::Index PairingHeap::pop()
+    {
+        Index min_index = root;
+        nodes[min_index].stamp = 0;
+        count--;
+
+        // Two-pass pairing: meld the children left to right in pairs, then fold the pairs right to left
+        pairs.clear();
+        Index child = nodes[min_index].child;
+        while (child != NIL)
+        {
+            Index first = child;
+            Index second = nodes[first].sibling;
+            child = (second == NIL) ? NIL : nodes[second].sibling;
+            nodes[first].sibling = nodes[first].prev = NIL;
+            if (second != NIL)
+            {
+                nodes[second].sibling = nodes[second].prev = NIL;
+                first = meld(first, second);
+            }
+            pairs.push_back(first);
+        }
+        root = NIL;
+        for (auto it = pairs.rbegin(); it != pairs.rend(); it++)
+            root = (root == NIL) ? *it : meld(root, *it);
+        return min_index;
+    }
+
+    inline PairingHeap::Index PairingHeap::meld(Index a, Index b)
+    {
+        if (nodes[b].key < nodes[a].key)
+            std::swap(a, b);
+        // b becomes the leftmost child of a
+        nodes[b].prev = a;
+        nodes[b].sibling = nodes[a].child;
+        if (nodes[a].child != NIL)
+            nodes[nodes[a].child].prev = b;
+        nodes[a].child = b;
+        nodes[a].sibling = nodes[a].prev = NIL;
+        return a;
+    }
+
+    inline void PairingHeap::cut(Index index)
+    {
+        Node &node = nodes[index];
+        if (nodes[node.prev].child == index)
+            nodes[node.prev].child = node.sibling;
+        else
+            nodes[node.prev].sibling = node.sibling;
+        if (node.sibling != NIL)
+            nodes[node.sibling].prev = node.prev;
+        node.sibling = node.prev = NIL;
+    }
+
+    // Radix heap for monotone keys (each pushed key is at least the last popped key, as in Dijkstra or
+    // A* with a consistent heuristic). Non-negative doubles are ordered by their IEEE bit pattern, so
+    // keys are bucketed on those bits and integer costs stay exact. A key below the last popped key is
+    // clamped to it, which keeps the heap valid but no longer exact for inconsistent heuristics.
+    class RadixHeap
+    {
+    public:
+        using Index = unsigned int;
+        using KeyType = double;
+
+        RadixHeap();
+        void reserve(std::size_t num_vertices);
+        void clear();
+        bool empty() const;
+        std::size_t size() const;
+        bool contains(Index index) const;
+        double top_key() const;
+        void push(Index index, double key);
+        Index pop();
+
+    private:
+        static constexpr unsigned int NUM_BUCKETS = 65;
+        static constexpr unsigned int NOT_QUEUED = UINT_MAX;
+
+        std::array<std::vector<Index>, NUM_BUCKETS> buckets;
+        std::vector<std::uint64_t> keys;
+        std::vector<unsigned int> bucket_of;
+        std::vector<unsigned int> slot_of;
+        std::uint64_t last_key;
+        std::size_t count;
+
+        static std::uint64_t to_bits(double key);
+        static double from_bits(std::uint64_t bits);
+        unsigned int find_bucket(std::uint64_t key) const;
+        void insert(Index index, unsigned int bucket);
+        void erase(Index index);
+    };
+
+    inline RadixHeap::RadixHeap() : last_key(0), count(0) {}
+
+    inline void RadixHeap::reserve(std::size_t num_vertices)
+    {
+        if (num_vertices > keys.size())
+        {
+            keys.resize(num_vertices, 0);
+            bucket_of.resize(num_vertices, NOT_QUEUED);
+            slot_of.resize(num_vertices, 0);
+        }
+    }
+
+    inline void RadixHeap::clear()
+    {
+        for (auto &bucket : buckets)
+        {
+            for (auto index : bucket)
+                bucket_of[index] = NOT_QUEUED;
+            bucket.clear();
+        }
+        last_key = 0;
+        count = 0;
+    }
+
+    inline bool RadixHeap::empty() const
+    {
+        return count == 0;
+    }
+
+    inline std::size_t RadixHeap::size() const
+    {
+        return count;
+    }
+
+    inline bool RadixHeap::contains(Index index) const
+    {
+        return bucket_of[index] != NOT_QUEUED;
+    }
+
+    inline double RadixHeap::top_key() const
+    {
+        if (!buckets[0].empty())
+            return from_bits(last_key);
+        unsigned int b = 1;
+        while (buckets[b].empty())
+            b++;
+        std::uint64_t min_key = UINT64_MAX;
+        for (auto index : buckets[b])
+            min_key = std::min(min_key, keys[index]);
+        return from_bits(min_key);
+    }
+
+    inline void RadixHeap::push(Index index, double key)
+    {
+        std::uint64_t bits = std::max(to_bits(key), last_key);
+        if (bucket_of[index] != NOT_QUEUED)
+        {
+            if (bits >= keys[index])
+                return;
+            erase(index);
+        }
+        keys[index] = bits;
+        insert(index, find_bucket(bits));
+        count++;
+    }
+
+    inline RadixHeap::Index RadixHeap::pop()
+    {
+        if (buckets[0].empty())
+        {
+            // Find the first non-empty bucket, its minimum becomes the new last key and every
+            // element of the bucket is redistributed into strictly lower buckets
+            unsigned int b = 1;
+            while (buckets[b].empty())
+                b++;
+            std::uint64_t min_key = UINT64_MAX;
+            for (auto index : buckets[b])
+                min_key = std::min(min_key, keys[index]);
+            last_key = min_key;
+
+            std::vector<Index> moved;
+            moved.swap(buckets[b]);
+            for (auto index : moved)
+                insert(index, find_bucket(keys[index]));
+            moved.clear();
+            moved.swap(buckets[b]);
+        }
+        Index index = buckets[0].back();
+        buckets[0].pop_back();
+        bucket_of[index] = NOT_QUEUED;
+        count--;
+        return index;
+    }
+
+    inline std::uint64_t RadixHeap::to_bits(double key)
+    {
+        // Negative zero and negative keys cannot occur for non-negative costs, clamp them to zero
+        if (!(key > 0))
+            return 0;
+        std::uint64_t bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        return bits;
+    }
+
+    inline double RadixHeap::from_bits(std::uint64_t bits)
+    {
+        double key;
+        std::memcpy(&key, &bits, sizeof(key));
+        return key;
+    }
+
+    inline unsigned int RadixHeap::find_bucket(std::uint64_t key) const
+    {
+        return key == last_key ? 0 : 64 - __builtin_clzll(key ^ last_key);
+    }
+
+    inline void RadixHeap::insert(Index index, unsigned int bucket)
+    {
+        bucket_of[index] = bucket;
+        slot_of[index] = buckets[bucket].size();
+        buckets[bucket].push_back(index);
+    }
+
+    inline void RadixHeap::erase(Index index)
+    {
+        auto &bucket = buckets[bucket_of[index]];
+        Index last = bucket.back();
+        bucket[slot_of[index]] = last;
+        slot_of[last] = slot_of[index];
+        bucket.pop_back();
+        bucket_of[index] = NOT_QUEUED;
+        count--;
+    }
+} // namespace algorithm
+
+#endif // QUEUE_H
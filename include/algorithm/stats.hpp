@@ -0,0 +1,80 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <vector>
+#include <cstddef>
+
+namespace algorithm
+{
+    // How much work one query did. The queues are addressable, so a vertex is queued at most once and
+    // a push on a queued vertex is a decrease-key instead of a duplicate entry that pops stale later.
+    struct SearchStats
+    {
+        const char *algorithm = "";
+        unsigned int start_position = 0;
+        unsigned int end_position = 0;
+        bool path_found = false; // A non-empty path was returned, so false when start and end coincide
+
+        std::size_t settled_vertices = 0;
+        std::size_t relaxed_edges = 0;
+        std::size_t queue_pushes = 0;
+        std::size_t decrease_keys = 0;
+        std::size_t peak_queue_size = 0;
+        std::size_t heuristic_calls = 0;
+
+        // Wall time per phase in milliseconds
+        double init_ms = 0;
+        double search_ms = 0;
+        double path_ms = 0;
+    };
+
+    // Called once per instrumented query, on the thread that ran it
+    using SearchStatsCallback = std::function<void(const SearchStats &)>;
+
+    // Phase timer, only read when a query is instrumented
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer();
+
+        // Milliseconds since the previous lap
+        double lap();
+
+    private:
+        std::chrono::steady_clock::time_point last;
+    };
+
+    // One JSON object per query, in an array
+    void write_stats_json(std::ostream &out, const std::vector<SearchStats> &stats);
+
+    inline PhaseTimer::PhaseTimer() : last(std::chrono::steady_clock::now()) {}
+
+    inline double PhaseTimer::lap()
+    {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(now - last).count();
+        last = now;
+        return elapsed;
+    }
+
+    inline void write_stats_json(std::ostream &out, const std::vector<SearchStats> &stats)
+    {
+        out << "[";
+        for (std::size_t i = 0; i < stats.size(); i++)
+        {
+            const SearchStats &query = stats[i];
+            out << (i ? ",\n " : "\n ") << "{\"algorithm\": \"" << query.algorithm << "\", \"start\": " << query.start_position
+                << ", \"end\": " << query.end_position << ", \"path_found\": " << (query.path_found ? "true" : "false")
+                << ", \"settled_vertices\": " << query.settled_vertices << ", \"relaxed_edges\": " << query.relaxed_edges
+                << ", \"queue_pushes\": " << query.queue_pushes << ", \"decrease_keys\": " << query.decrease_keys
+                << ", \"peak_queue_size\": " << query.peak_queue_size << ", \"heuristic_calls\": " << query.heuristic_calls
+                << ", \"init_ms\": " << query.init_ms << ", \"search_ms\": " << query.search_ms << ", \"path_ms\": " << query.path_ms << "}";
+        }
+        out << (stats.empty() ? "]" : "\n]") << std::endl;
+    }
+} // namespace algorithm
+
+#endif // STATS_H
@@ -0,0 +1,205 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <vector>
+#include <limits>
+#include <climits>
+#include <algorithm>
+#include "queue.hpp"
+#include "stats.hpp"
+
+namespace algorithm
+{
+    // Per-graph scratch state for the search algorithms. The cost and predecessor tables are
+    // dense arrays stamped with a generation counter, so starting a new query only bumps the
+    // generation instead of touching every vertex. The priority queue policy is a template
+    // parameter (see queue.hpp). One workspace must not be shared between threads running
+    // concurrent queries.
+    template <class Queue = QuadHeap>
+    class SearchWorkspace
+    {
+    public:
+        using Index = unsigned int;
+        using QueueType = Queue;
+
+        static constexpr Index INVALID_INDEX = UINT_MAX;
+
+        SearchWorkspace();
+        explicit SearchWorkspace(std::size_t num_vertices);
+
+        // Sizing and per-query reset
+        void resize(std::size_t num_vertices);
+        std::size_t size() const;
+        void reset();
+
+        // Per-vertex state for the current query
+        bool is_reached(Index index) const;
+        double get_cost(Index index) const;
+        Index get_previous(Index index) const;
+        void set_label(Index index, double cost, Index previous);
+
+        // Heuristic estimates computed during the current query
+        bool has_estimate(Index index) const;
+        double get_estimate(Index index) const;
+        void set_estimate(Index index, double estimate);
+
+        // Reusable priority queue
+        Queue &get_queue();
+
+        // Reusable buffers for per-query lists (targets, batched neighbors), so that queries on a warm
+        // workspace allocate nothing. Their contents are owned by whichever search is running.
+        std::vector<Index> &get_index_scratch();
+        std::vector<double> &get_cost_scratch();
+
+        // Optional instrumentation. With a callback set, the searches count their work into get_stats()
+        // and the path searches pass it to the callback once the path is reconstructed.
+        void set_stats_callback(SearchStatsCallback callback);
+        bool is_instrumented() const;
+        SearchStats &get_stats();
+        void report_stats();
+
+    private:
+        std::vector<double> costs;
+        std::vector<Index> previous;
+        std::vector<unsigned int> stamps;
+        std::vector<double> estimates;
+        std::vector<unsigned int> estimate_stamps;
+        Queue queue;
+        std::vector<Index> index_scratch;
+        std::vector<double> cost_scratch;
+        SearchStats stats;
+        SearchStatsCallback stats_callback;
+        unsigned int generation;
+    };
+
+    template <class Queue>
+    inline SearchWorkspace<Queue>::SearchWorkspace() : generation(1) {}
+
+    template <class Queue>
+    inline SearchWorkspace<Queue>::SearchWorkspace(std::size_t num_vertices) : generation(1)
+    {
+        resize(num_vertices);
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::resize(std::size_t num_vertices)
+    {
+        if (num_vertices <= stamps.size())
+            return;
+        costs.resize(num_vertices, std::numeric_limits<double>::infinity());
+        previous.resize(num_vertices, INVALID_INDEX);
+        stamps.resize(num_vertices, 0);
+        estimates.resize(num_vertices, 0);
+        estimate_stamps.resize(num_vertices, 0);
+        queue.reserve(num_vertices);
+    }
+
+    template <class Queue>
+    inline std::size_t SearchWorkspace<Queue>::size() const
+    {
+        return stamps.size();
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::reset()
+    {
+        queue.clear();
+        if (++generation == 0)
+        {
+            // The counter wrapped around, old stamps could alias the new generation
+            std::fill(stamps.begin(), stamps.end(), 0);
+            std::fill(estimate_stamps.begin(), estimate_stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    template <class Queue>
+    inline bool SearchWorkspace<Queue>::is_reached(Index index) const
+    {
+        return stamps[index] == generation;
+    }
+
+    template <class Queue>
+    inline double SearchWorkspace<Queue>::get_cost(Index index) const
+    {
+        return is_reached(index) ? costs[index] : std::numeric_limits<double>::infinity();
+    }
+
+    template <class Queue>
+    inline typename SearchWorkspace<Queue>::Index SearchWorkspace<Queue>::get_previous(Index index) const
+    {
+        return is_reached(index) ? previous[index] : INVALID_INDEX;
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::set_label(Index index, double cost, Index previous_index)
+    {
+        stamps[index] = generation;
+        costs[index] = cost;
+        previous[index] = previous_index;
+    }
+
+    template <class Queue>
+    inline bool SearchWorkspace<Queue>::has_estimate(Index index) const
+    {
+        return estimate_stamps[index] == generation;
+    }
+
+    template <class Queue>
+    inline double SearchWorkspace<Queue>::get_estimate(Index index) const
+    {
+        return estimates[index];
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::set_estimate(Index index, double estimate)
+    {
+        estimate_stamps[index] = generation;
+        estimates[index] = estimate;
+    }
+
+    template <class Queue>
+    inline Queue &SearchWorkspace<Queue>::get_queue()
+    {
+        return queue;
+    }
+
+    template <class Queue>
+    inline std::vector<typename SearchWorkspace<Queue>::Index> &SearchWorkspace<Queue>::get_index_scratch()
+    {
+        return index_scratch;
+    }
+
+    template <class Queue>
+    inline std::vector<double> &SearchWorkspace<Queue>::get_cost_scratch()
+    {
+        return cost_scratch;
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::set_stats_callback(SearchStatsCallback callback)
+    {
+        stats_callback = std::move(callback);
+    }
+
+    template <class Queue>
+    inline bool SearchWorkspace<Queue>::is_instrumented() const
+    {
+        return static_cast<bool>(stats_callback);
+    }
+
+    template <class Queue>
+    inline SearchStats &SearchWorkspace<Queue>::get_stats()
+    {
+        return stats;
+    }
+
+    template <class Queue>
+    inline void SearchWorkspace<Queue>::report_stats()
+    {
+        if (stats_callback)
+            stats_callback(stats);
+    }
+} // namespace algorithm
+
+#endif // WORKSPACE_H
@@ -0,0 +1,94 @@
+#ifndef GRAPH_OUTPUT_H
+#define GRAPH_OUTPUT_H
+
+#include <string>
+#include <vector>
+#include "random_graph.hpp"
+#include "../graph/graph_builder.hpp"
+#include "../parser/snapshot.hpp"
+#include "../parser/writer.hpp"
+
+namespace generator
+{
+    enum class GraphFormat
+    {
+        TEXT,    // The graph file format read by GraphFileReader
+        SNAPSHOT // Binary snapshot, see parser/snapshot.hpp
+    };
+
+    // Write a generated graph. Text lines are formatted in chunks on the pool and handed to an async
+    // GraphFileWriter in order, a few chunks per thread at a time, so memory stays bounded, the disk
+    // works while the next chunks are formatted, and the file is the same for any pool.
+    template <class T>
+    void write_random_graph(const RandomGraph<T> &graph, const std::string &filename, GraphFormat format, parallel::ThreadPool *pool = nullptr);
+
+    namespace detail
+    {
+        // Format the lines of [0, count) into chunk buffers and pass them to the writer in order
+        template <class T, class Format>
+        void write_lines(parser::GraphFileWriter<T> &writer, parallel::ThreadPool *pool, std::size_t count, Format format)
+        {
+            const std::size_t num_chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            const std::size_t wave = pool ? 4 * std::size_t(pool->get_num_threads()) : 1;
+            std::vector<std::string> buffers(wave);
+            for (std::size_t first_chunk = 0; first_chunk < num_chunks; first_chunk += wave)
+            {
+                const std::size_t wave_chunks = std::min(wave, num_chunks - first_chunk);
+                auto format_chunk = [&](std::size_t slot)
+                {
+                    std::string &buffer = buffers[slot];
+                    buffer.clear();
+                    const std::size_t first = (first_chunk + slot) * CHUNK_SIZE;
+                    for (std::size_t i = first; i < std::min(count, first + CHUNK_SIZE); i++)
+                        format(buffer, i);
+                };
+                if (pool && wave_chunks > 1)
+                    parallel::for_each_index(*pool, wave_chunks, []()
+                                             { return 0; }, [&](int, std::size_t slot)
+                                             { format_chunk(slot); });
+                else
+                {
+                    for (std::size_t slot = 0; slot < wave_chunks; slot++)
+                        format_chunk(slot);
+                }
+                for (std::size_t slot = 0; slot < wave_chunks; slot++)
+                    writer.write_lines(buffers[slot]);
+            }
+        }
+    } // namespace detail
+
+    template <class T>
+    inline void write_random_graph(const RandomGraph<T> &graph, const std::string &filename, GraphFormat format, parallel::ThreadPool *pool)
+    {
+        if (format == GraphFormat::SNAPSHOT)
+        {
+            graph::GraphBuilder<T> builder;
+            builder.reserve_vertices(graph.vertices.size());
+            builder.reserve_edges(graph.edges.size());
+            for (const auto &vertex : graph.vertices)
+                builder.add_vertex(std::get<0>(vertex), std::get<1>(vertex), std::get<2>(vertex));
+            for (const auto &edge : graph.edges)
+                builder.add_edge(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge));
+            parser::write_snapshot(filename, builder.build(), graph.start_end);
+            return;
+        }
+
+        parser::GraphFileWriter<T> writer(filename, true);
+        writer.write_start_end(graph.start_end);
+        writer.write_section_header("Vertices");
+        detail::write_lines(writer, pool, graph.vertices.size(), [&](std::string &buffer, std::size_t i)
+                            {
+            const auto &vertex = graph.vertices[i];
+            parser::append_vertex_line(buffer, std::get<0>(vertex), std::get<1>(vertex), std::get<2>(vertex)); });
+        writer.end_section();
+        writer.write_section_header("Edges");
+        detail::write_lines(writer, pool, graph.edges.size(), [&](std::string &buffer, std::size_t i)
+                            {
+            const auto &edge = graph.edges[i];
+            parser::append_edge_line(buffer, std::get<0>(edge), std::get<1>(edge), std::get<2>(edge)); });
+        writer.end_section();
+        writer.close();
+    }
+} // namespace generator
+
+#endif // GRAPH_OUTPUT_H
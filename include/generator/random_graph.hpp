@@ -0,0 +1,392 @@
+#ifndef RANDOM_GRAPH_H
+#define RANDOM_GRAPH_H
+
+#include <vector>
+#include <tuple>
+#include <array>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Delaunay_triangulation_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include "../parallel/thread_pool.hpp"
+
+namespace generator
+{
+    enum class GraphModel
+    {
+        UNIFORM,  // Uniformly random pairs of vertices, integer coordinates and costs
+        GRID,     // Jittered street grid with some streets missing, road-like
+        KNN,      // Every vertex joined to its k nearest neighbours
+        DELAUNAY  // Delaunay triangulation of random points, planar like a road network
+    };
+
+    struct RandomGraphOptions
+    {
+        GraphModel model = GraphModel::UNIFORM;
+        unsigned int num_vertices = 0;
+        unsigned int num_edges = 0;    // UNIFORM only, the other models derive it from their structure
+        unsigned int max_bound = 1000; // Coordinates lie in [1, max_bound], integers for UNIFORM
+        unsigned int max_cost = 10;    // UNIFORM costs are integers in [0, max_cost)
+        unsigned int k = 4;            // KNN neighbours per vertex
+        double removed_streets = 0.1;  // GRID fraction of streets left out
+        double max_detour = 1.5;       // Geometric models cost the length times a factor in [1, max_detour)
+        unsigned int start = 0;
+        unsigned int end = 0;
+        unsigned int seed = 1;
+    };
+
+    // A graph in the element form taken by the graph constructors and the file writer
+    template <class T>
+    struct RandomGraph
+    {
+        std::tuple<unsigned int, unsigned int> start_end;
+        std::vector<std::tuple<unsigned int, T, T>> vertices;
+        std::vector<std::tuple<unsigned int, unsigned int, double>> edges;
+    };
+
+    // Generate a graph with vertices at positions 0..n-1. The work is split into fixed chunks with a
+    // random stream each, seeded from the options' seed and the chunk number, so the same options give
+    // the same graph whether a pool is given or not and however many threads it has. UNIFORM graphs
+    // have self-loops, parallel edges and zero costs like the bundled inputs. The geometric models
+    // connect nearby vertices in both directions and never cost less than the Euclidean length, so
+    // the Euclidean A* heuristic stays admissible on them.
+    template <class T>
+    RandomGraph<T> generate_random_graph(const RandomGraphOptions &options, parallel::ThreadPool *pool = nullptr);
+
+    namespace detail
+    {
+        using Edges = std::vector<std::tuple<unsigned int, unsigned int, double>>;
+
+        constexpr std::size_t CHUNK_SIZE = 1 << 14;
+
+        // Random streams of the generation phases
+        enum Stream : unsigned int
+        {
+            VERTEX_STREAM = 1,
+            EDGE_STREAM = 2,
+            COST_STREAM = 3
+        };
+
+        inline std::mt19937_64 make_rng(unsigned int seed, Stream stream, std::size_t chunk)
+        {
+            std::seed_seq sequence{seed, static_cast<unsigned int>(stream), static_cast<unsigned int>(chunk),
+                                   static_cast<unsigned int>(chunk >> 32)};
+            return std::mt19937_64(sequence);
+        }
+
+        // Draws of our own instead of the standard distributions, whose output differs between
+        // standard libraries
+        inline double draw_unit(std::mt19937_64 &rng)
+        {
+            return (rng() >> 11) * 0x1.0p-53;
+        }
+
+        inline std::uint64_t draw_below(std::mt19937_64 &rng, std::uint64_t bound)
+        {
+            return std::min<std::uint64_t>(static_cast<std::uint64_t>(draw_unit(rng) * bound), bound - 1);
+        }
+
+        // Run body(chunk, first, last) for the chunks of [0, count), on the pool when there is one
+        template <class Body>
+        void for_each_chunk(parallel::ThreadPool *pool, std::size_t count, Body body)
+        {
+            const std::size_t num_chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+            auto run = [&](std::size_t chunk)
+            { body(chunk, chunk * CHUNK_SIZE, std::min(count, (chunk + 1) * CHUNK_SIZE)); };
+            if (!pool || num_chunks <= 1)
+            {
+                for (std::size_t chunk = 0; chunk < num_chunks; chunk++)
+                    run(chunk);
+                return;
+            }
+            parallel::for_each_index(*pool, num_chunks, []()
+                                     { return 0; }, [&](int, std::size_t chunk)
+                                     { run(chunk); });
+        }
+
+        // Edges generated per chunk of source vertices, joined in chunk order
+        template <class Generate>
+        Edges generate_edges(parallel::ThreadPool *pool, std::size_t count, Generate generate)
+        {
+            std::vector<Edges> chunks((count + CHUNK_SIZE - 1) / CHUNK_SIZE);
+            for_each_chunk(pool, count, [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           { generate(chunk, first, last, chunks[chunk]); });
+            std::size_t total = 0;
+            for (const auto &chunk : chunks)
+                total += chunk.size();
+            Edges edges;
+            edges.reserve(total);
+            for (auto &chunk : chunks)
+            {
+                edges.insert(edges.end(), chunk.begin(), chunk.end());
+                Edges().swap(chunk);
+            }
+            return edges;
+        }
+
+        template <class T>
+        double get_length(const RandomGraph<T> &graph, unsigned int source, unsigned int target)
+        {
+            double dx = double(std::get<1>(graph.vertices[source])) - double(std::get<1>(graph.vertices[target]));
+            double dy = double(std::get<2>(graph.vertices[source])) - double(std::get<2>(graph.vertices[target]));
+            return std::sqrt(dx * dx + dy * dy);
+        }
+
+        template <class T>
+        double draw_road_cost(const RandomGraph<T> &graph, const RandomGraphOptions &options, std::mt19937_64 &rng,
+                              unsigned int source, unsigned int target)
+        {
+            return get_length(graph, source, target) * (1 + draw_unit(rng) * (options.max_detour - 1));
+        }
+
+        template <class T>
+        void generate_uniform(RandomGraph<T> &graph, const RandomGraphOptions &options, parallel::ThreadPool *pool)
+        {
+            graph.vertices.resize(options.num_vertices);
+            for_each_chunk(pool, options.num_vertices, [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           {
+                auto rng = make_rng(options.seed, VERTEX_STREAM, chunk);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    T x = 1 + draw_below(rng, options.max_bound);
+                    T y = 1 + draw_below(rng, options.max_bound);
+                    graph.vertices[i] = std::make_tuple(static_cast<unsigned int>(i), x, y);
+                } });
+            graph.edges.resize(options.num_edges);
+            for_each_chunk(pool, options.num_edges, [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           {
+                auto rng = make_rng(options.seed, EDGE_STREAM, chunk);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    unsigned int source = draw_below(rng, options.num_vertices);
+                    unsigned int target = draw_below(rng, options.num_vertices);
+                    graph.edges[i] = std::make_tuple(source, target, double(draw_below(rng, options.max_cost)));
+                } });
+        }
+
+        // Points spread uniformly over the square, as real numbers
+        template <class T>
+        void generate_points(RandomGraph<T> &graph, const RandomGraphOptions &options, parallel::ThreadPool *pool)
+        {
+            graph.vertices.resize(options.num_vertices);
+            const double extent = options.max_bound - 1;
+            for_each_chunk(pool, options.num_vertices, [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           {
+                auto rng = make_rng(options.seed, VERTEX_STREAM, chunk);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    T x = 1 + draw_unit(rng) * extent;
+                    T y = 1 + draw_unit(rng) * extent;
+                    graph.vertices[i] = std::make_tuple(static_cast<unsigned int>(i), x, y);
+                } });
+        }
+
+        template <class T>
+        void generate_grid(RandomGraph<T> &graph, const RandomGraphOptions &options, parallel::ThreadPool *pool)
+        {
+            // Row-major blocks with a spacing that fits the grid into the bounds, the last row may be short
+            const unsigned int n = options.num_vertices;
+            const unsigned int width = static_cast<unsigned int>(std::ceil(std::sqrt(double(n))));
+            const double spacing = double(options.max_bound - 1) / width;
+            graph.vertices.resize(n);
+            for_each_chunk(pool, n, [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           {
+                auto rng = make_rng(options.seed, VERTEX_STREAM, chunk);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    T x = 1 + (i % width + 0.2 + 0.6 * draw_unit(rng)) * spacing;
+                    T y = 1 + (i / width + 0.2 + 0.6 * draw_unit(rng)) * spacing;
+                    graph.vertices[i] = std::make_tuple(static_cast<unsigned int>(i), x, y);
+                } });
+
+            // Every vertex owns the streets to its right and lower neighbours, both ways
+            graph.edges = generate_edges(pool, n, [&](std::size_t chunk, std::size_t first, std::size_t last, Edges &edges)
+                                         {
+                auto rng = make_rng(options.seed, EDGE_STREAM, chunk);
+                edges.reserve((last - first) * 4);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    unsigned int source = i;
+                    std::array<unsigned int, 2> neighbors{i % width + 1 < width && i + 1 < n ? source + 1 : source,
+                                                          i + width < n ? source + width : source};
+                    for (unsigned int target : neighbors)
+                    {
+                        bool removed = draw_unit(rng) < options.removed_streets;
+                        double cost = draw_road_cost(graph, options, rng, source, target);
+                        if (target == source || removed)
+                            continue;
+                        edges.emplace_back(source, target, cost);
+                        edges.emplace_back(target, source, cost);
+                    }
+                } });
+        }
+
+        template <class T>
+        void generate_knn(RandomGraph<T> &graph, const RandomGraphOptions &options, parallel::ThreadPool *pool)
+        {
+            const unsigned int n = options.num_vertices;
+            const unsigned int k = std::min(options.k, n - 1);
+            generate_points(graph, options, pool);
+            if (k == 0)
+                return;
+
+            // Bucket the points into square cells holding about two points each
+            const unsigned int cells_per_side = std::max(1u, static_cast<unsigned int>(std::sqrt(n / 2.0)));
+            const double cell_size = double(options.max_bound - 1) / cells_per_side;
+            auto cell_of = [&](double coordinate)
+            { return std::min(cells_per_side - 1, static_cast<unsigned int>(std::max(0.0, (coordinate - 1) / cell_size))); };
+            std::vector<unsigned int> cell_offsets(std::size_t(cells_per_side) * cells_per_side + 1, 0);
+            std::vector<unsigned int> cell_points(n);
+            auto cell_index = [&](unsigned int i)
+            { return std::size_t(cell_of(std::get<2>(graph.vertices[i]))) * cells_per_side + cell_of(std::get<1>(graph.vertices[i])); };
+            for (unsigned int i = 0; i < n; i++)
+                cell_offsets[cell_index(i) + 1]++;
+            for (std::size_t cell = 0; cell + 1 < cell_offsets.size(); cell++)
+                cell_offsets[cell + 1] += cell_offsets[cell];
+            {
+                std::vector<unsigned int> fill(cell_offsets.begin(), cell_offsets.end() - 1);
+                for (unsigned int i = 0; i < n; i++)
+                    cell_points[fill[cell_index(i)]++] = i;
+            }
+
+            // Nearest neighbours found ring by ring around the point's cell. Points beyond ring r are
+            // at least r cells away, so the search stops once the k-th distance is within that.
+            std::vector<unsigned int> neighbors(std::size_t(n) * k);
+            for_each_chunk(pool, n, [&](std::size_t, std::size_t first, std::size_t last)
+                           {
+                std::vector<std::pair<double, unsigned int>> nearest;
+                for (std::size_t i = first; i < last; i++)
+                {
+                    nearest.clear();
+                    const int cx = cell_of(std::get<1>(graph.vertices[i]));
+                    const int cy = cell_of(std::get<2>(graph.vertices[i]));
+                    for (int ring = 0; ring < int(cells_per_side); ring++)
+                    {
+                        for (int y = cy - ring; y <= cy + ring; y++)
+                        {
+                            for (int x = cx - ring; x <= cx + ring; x++)
+                            {
+                                bool on_ring = y == cy - ring || y == cy + ring || x == cx - ring || x == cx + ring;
+                                if (!on_ring || x < 0 || y < 0 || x >= int(cells_per_side) || y >= int(cells_per_side))
+                                    continue;
+                                std::size_t cell = std::size_t(y) * cells_per_side + x;
+                                for (unsigned int slot = cell_offsets[cell]; slot < cell_offsets[cell + 1]; slot++)
+                                {
+                                    unsigned int candidate = cell_points[slot];
+                                    if (candidate == i)
+                                        continue;
+                                    // Ties are broken by index, so the result does not depend on the visiting order
+                                    std::pair<double, unsigned int> entry(get_length(graph, i, candidate), candidate);
+                                    if (nearest.size() == k && !(entry < nearest.back()))
+                                        continue;
+                                    if (nearest.size() == k)
+                                        nearest.pop_back();
+                                    nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), entry), entry);
+                                }
+                            }
+                        }
+                        if (nearest.size() == k && nearest.back().first <= ring * cell_size)
+                            break;
+                    }
+                    for (unsigned int j = 0; j < k; j++)
+                        neighbors[i * k + j] = nearest[j].second;
+                } });
+
+            // One road per neighbour pair in both directions, a mutual pair is emitted by its lower vertex
+            graph.edges = generate_edges(pool, n, [&](std::size_t chunk, std::size_t first, std::size_t last, Edges &edges)
+                                         {
+                auto rng = make_rng(options.seed, EDGE_STREAM, chunk);
+                edges.reserve((last - first) * k * 2);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    for (unsigned int j = 0; j < k; j++)
+                    {
+                        unsigned int source = i, target = neighbors[i * k + j];
+                        auto back = neighbors.begin() + std::size_t(target) * k;
+                        if (target < source && std::find(back, back + k, source) != back + k)
+                            continue;
+                        double cost = draw_road_cost(graph, options, rng, source, target);
+                        edges.emplace_back(source, target, cost);
+                        edges.emplace_back(target, source, cost);
+                    }
+                } });
+        }
+
+        template <class T>
+        void generate_delaunay(RandomGraph<T> &graph, const RandomGraphOptions &options, parallel::ThreadPool *pool)
+        {
+            using Kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
+            using VertexBase = CGAL::Triangulation_vertex_base_with_info_2<unsigned int, Kernel>;
+            using DataStructure = CGAL::Triangulation_data_structure_2<VertexBase>;
+            using Delaunay = CGAL::Delaunay_triangulation_2<Kernel, DataStructure>;
+
+            generate_points(graph, options, pool);
+            std::vector<std::pair<Kernel::Point_2, unsigned int>> points;
+            points.reserve(graph.vertices.size());
+            for (const auto &vertex : graph.vertices)
+                points.emplace_back(Kernel::Point_2(std::get<1>(vertex), std::get<2>(vertex)), std::get<0>(vertex));
+
+            // The triangulation is sequential, costs are drawn per chunk of triangulation edges
+            Delaunay triangulation;
+            triangulation.insert(points.begin(), points.end());
+            std::vector<std::pair<unsigned int, unsigned int>> roads;
+            roads.reserve(triangulation.number_of_vertices() * 3);
+            for (auto edge = triangulation.finite_edges_begin(); edge != triangulation.finite_edges_end(); ++edge)
+            {
+                unsigned int source = edge->first->vertex(Delaunay::cw(edge->second))->info();
+                unsigned int target = edge->first->vertex(Delaunay::ccw(edge->second))->info();
+                roads.emplace_back(std::min(source, target), std::max(source, target));
+            }
+            std::sort(roads.begin(), roads.end());
+
+            graph.edges.resize(roads.size() * 2);
+            for_each_chunk(pool, roads.size(), [&](std::size_t chunk, std::size_t first, std::size_t last)
+                           {
+                auto rng = make_rng(options.seed, COST_STREAM, chunk);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    double cost = draw_road_cost(graph, options, rng, roads[i].first, roads[i].second);
+                    graph.edges[2 * i] = std::make_tuple(roads[i].first, roads[i].second, cost);
+                    graph.edges[2 * i + 1] = std::make_tuple(roads[i].second, roads[i].first, cost);
+                } });
+        }
+    } // namespace detail
+
+    template <class T>
+    inline RandomGraph<T> generate_random_graph(const RandomGraphOptions &options, parallel::ThreadPool *pool)
+    {
+        if (options.num_vertices == 0)
+            throw std::invalid_argument("A random graph needs at least one vertex.");
+        if (options.max_bound < 2 || options.max_cost == 0)
+            throw std::invalid_argument("The coordinate bound must be at least 2 and the cost bound positive.");
+        if (options.start >= options.num_vertices || options.end >= options.num_vertices)
+            throw std::invalid_argument("The start and end vertices must be below the number of vertices.");
+        if (options.max_detour < 1 || options.removed_streets < 0 || options.removed_streets > 1)
+            throw std::invalid_argument("The detour factor must be at least 1 and the removed street fraction within [0, 1].");
+
+        RandomGraph<T> graph;
+        graph.start_end = std::make_tuple(options.start, options.end);
+        switch (options.model)
+        {
+        case GraphModel::UNIFORM:
+            detail::generate_uniform(graph, options, pool);
+            break;
+        case GraphModel::GRID:
+            detail::generate_grid(graph, options, pool);
+            break;
+        case GraphModel::KNN:
+            detail::generate_knn(graph, options, pool);
+            break;
+        case GraphModel::DELAUNAY:
+            detail::generate_delaunay(graph, options, pool);
+            break;
+        }
+        return graph;
+    }
+} // namespace generator
+
+#endif // RANDOM_GRAPH_H
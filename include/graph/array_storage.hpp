@@ -0,0 +1,92 @@
+#ifndef ARRAY_STORAGE_H
+#define ARRAY_STORAGE_H
+
+#include <vector>
+#include <memory>
+
+namespace graph
+{
+    // Immutable array that either owns its elements or views memory kept alive by someone else, such
+    // as the pages of a memory-mapped snapshot. Copies share the elements instead of duplicating them.
+    template <class V>
+    class ArrayStorage
+    {
+    public:
+        ArrayStorage();
+        ArrayStorage(std::vector<V> values);
+        ArrayStorage(const V *data, std::size_t size, std::shared_ptr<const void> keepalive);
+
+        std::size_t size() const;
+        bool empty() const;
+        const V *data() const;
+        const V *begin() const;
+        const V *end() const;
+        const V &operator[](std::size_t i) const;
+        const V &back() const;
+
+    private:
+        const V *pointer;
+        std::size_t length;
+        std::shared_ptr<const void> keepalive;
+    };
+
+    template <class V>
+    inline ArrayStorage<V>::ArrayStorage() : pointer(nullptr), length(0) {}
+
+    template <class V>
+    inline ArrayStorage<V>::ArrayStorage(std::vector<V> values)
+    {
+        auto owned = std::make_shared<const std::vector<V>>(std::move(values));
+        pointer = owned->data();
+        length = owned->size();
+        keepalive = std::move(owned);
+    }
+
+    template <class V>
+    inline ArrayStorage<V>::ArrayStorage(const V *data, std::size_t size, std::shared_ptr<const void> keepalive)
+        : pointer(data), length(size), keepalive(std::move(keepalive)) {}
+
+    template <class V>
+    inline std::size_t ArrayStorage<V>::size() const
+    {
+        return length;
+    }
+
+    template <class V>
+    inline bool ArrayStorage<V>::empty() const
+    {
+        return length == 0;
+    }
+
+    template <class V>
+    inline const V *ArrayStorage<V>::data() const
+    {
+        return pointer;
+    }
+
+    template <class V>
+    inline const V *ArrayStorage<V>::begin() const
+    {
+        return pointer;
+    }
+
+    template <class V>
+    inline const V *ArrayStorage<V>::end() const
+    {
+        return pointer + length;
+    }
+
+    template <class V>
+    inline const V &ArrayStorage<V>::operator[](std::size_t i) const
+    {
+        return pointer[i];
+    }
+
+    template <class V>
+    inline const V &ArrayStorage<V>::back() const
+    {
+        return pointer[length - 1];
+    }
+} // namespace graph
+
+#endif // ARRAY_STORAGE_H
@@ -0,0 +1,255 @@
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <vector>
+#include <algorithm>
+#include "csr_graph.hpp"
+
+namespace graph
+{
+    // Visit every vertex reachable from the start over outgoing edges, in breadth-first or depth-first
+    // (preorder) order. Visits are tracked in a bitset local to the call, so concurrent searches on one
+    // graph are safe. visit(index) returns false to stop the search early.
+    template <class T, class Visit>
+    void breadth_first_search(const CSRGraph<T> &csr, typename CSRGraph<T>::Index start_index, Visit visit);
+    template <class T, class Visit>
+    void depth_first_search(const CSRGraph<T> &csr, typename CSRGraph<T>::Index start_index, Visit visit);
+
+    // Weakly and strongly connected components of a CSR graph, computed once and then answered in
+    // constant time. Every edge counts, including untraversable ones, so the answers stay conservative
+    // when dynamic costs make such an edge traversable.
+    //
+    // Strong components are numbered by Tarjan's algorithm, which emits them in reverse topological
+    // order of the condensation: a path from u to v implies strong(v) <= strong(u). Together with the
+    // weak components this proves most unreachable pairs without a search.
+    template <class T>
+    class Connectivity
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+
+        Connectivity() = default;
+        explicit Connectivity(const CSRGraph<T> &csr);
+
+        std::size_t get_num_weak_components() const;
+        std::size_t get_num_strong_components() const;
+        unsigned int get_weak_component(Index index) const;
+        unsigned int get_strong_component(Index index) const;
+
+        // False proves that no path leads from one vertex to the other. True only means that a
+        // search is needed, unless both lie in the same strong component, where a path always exists.
+        bool may_reach(Index from_index, Index to_index) const;
+        bool same_strong_component(Index from_index, Index to_index) const;
+
+    private:
+        std::vector<unsigned int> weak_components;
+        std::vector<unsigned int> strong_components;
+        std::size_t num_weak_components = 0;
+        std::size_t num_strong_components = 0;
+
+        void compute_weak_components(const CSRGraph<T> &csr);
+        void compute_strong_components(const CSRGraph<T> &csr);
+    };
+
+    template <class T, class Visit>
+    inline void breadth_first_search(const CSRGraph<T> &csr, typename CSRGraph<T>::Index start_index, Visit visit)
+    {
+        using Index = typename CSRGraph<T>::Index;
+        std::vector<bool> visited(csr.get_num_vertices(), false);
+        std::vector<Index> queue;
+        visited[start_index] = true;
+        queue.push_back(start_index);
+        for (std::size_t head = 0; head < queue.size(); head++)
+        {
+            Index current_index = queue[head];
+            if (!visit(current_index))
+                return;
+            for (auto edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+            {
+                Index neighbor_index = csr.get_target(edge);
+                if (!visited[neighbor_index])
+                {
+                    visited[neighbor_index] = true;
+                    queue.push_back(neighbor_index);
+                }
+            }
+        }
+    }
+
+    template <class T, class Visit>
+    inline void depth_first_search(const CSRGraph<T> &csr, typename CSRGraph<T>::Index start_index, Visit visit)
+    {
+        using Index = typename CSRGraph<T>::Index;
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+        std::vector<bool> visited(csr.get_num_vertices(), false);
+
+        // Explicit stack of (vertex, next edge to follow), so the order matches a recursive search
+        std::vector<std::pair<Index, EdgeIndex>> stack;
+        visited[start_index] = true;
+        if (!visit(start_index))
+            return;
+        stack.emplace_back(start_index, csr.edges_begin(start_index));
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            if (top.second == csr.edges_end(top.first))
+            {
+                stack.pop_back();
+                continue;
+            }
+            Index neighbor_index = csr.get_target(top.second++);
+            if (!visited[neighbor_index])
+            {
+                visited[neighbor_index] = true;
+                if (!visit(neighbor_index))
+                    return;
+                stack.emplace_back(neighbor_index, csr.edges_begin(neighbor_index));
+            }
+        }
+    }
+
+    template <class T>
+    inline Connectivity<T>::Connectivity(const CSRGraph<T> &csr)
+    {
+        compute_weak_components(csr);
+        compute_strong_components(csr);
+    }
+
+    template <class T>
+    inline std::size_t Connectivity<T>::get_num_weak_components() const
+    {
+        return num_weak_components;
+    }
+
+    template <class T>
+    inline std::size_t Connectivity<T>::get_num_strong_components() const
+    {
+        return num_strong_components;
+    }
+
+    template <class T>
+    inline unsigned int Connectivity<T>::get_weak_component(Index index) const
+    {
+        return weak_components[index];
+    }
+
+    template <class T>
+    inline unsigned int Connectivity<T>::get_strong_component(Index index) const
+    {
+        return strong_components[index];
+    }
+
+    template <class T>
+    inline bool Connectivity<T>::may_reach(Index from_index, Index to_index) const
+    {
+        return weak_components[from_index] == weak_components[to_index] && strong_components[to_index] <= strong_components[from_index];
+    }
+
+    template <class T>
+    inline bool Connectivity<T>::same_strong_component(Index from_index, Index to_index) const
+    {
+        return strong_components[from_index] == strong_components[to_index];
+    }
+
+    template <class T>
+    inline void Connectivity<T>::compute_weak_components(const CSRGraph<T> &csr)
+    {
+        // Breadth-first over the edges in both directions, the component ids double as visit marks
+        const std::size_t num_vertices = csr.get_num_vertices();
+        weak_components.assign(num_vertices, CSRGraph<T>::INVALID_INDEX);
+        std::vector<Index> queue;
+        queue.reserve(num_vertices);
+        for (Index root = 0; root < num_vertices; root++)
+        {
+            if (weak_components[root] != CSRGraph<T>::INVALID_INDEX)
+                continue;
+            const unsigned int component = num_weak_components++;
+            queue.clear();
+            queue.push_back(root);
+            weak_components[root] = component;
+            for (std::size_t head = 0; head < queue.size(); head++)
+            {
+                Index current_index = queue[head];
+                auto reach = [&](Index neighbor_index)
+                {
+                    if (weak_components[neighbor_index] == CSRGraph<T>::INVALID_INDEX)
+                    {
+                        weak_components[neighbor_index] = component;
+                        queue.push_back(neighbor_index);
+                    }
+                };
+                for (auto edge = csr.edges_begin(current_index); edge != csr.edges_end(current_index); edge++)
+                    reach(csr.get_target(edge));
+                for (auto in_edge = csr.in_edges_begin(current_index); in_edge != csr.in_edges_end(current_index); in_edge++)
+                    reach(csr.get_source(in_edge));
+            }
+        }
+    }
+
+    template <class T>
+    inline void Connectivity<T>::compute_strong_components(const CSRGraph<T> &csr)
+    {
+        // Tarjan's algorithm with an explicit call stack, so deep graphs cannot overflow the thread stack
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+        constexpr unsigned int UNVISITED = CSRGraph<T>::INVALID_INDEX;
+        const std::size_t num_vertices = csr.get_num_vertices();
+        std::vector<unsigned int> order(num_vertices, UNVISITED);
+        std::vector<unsigned int> low(num_vertices);
+        std::vector<bool> on_stack(num_vertices, false);
+        std::vector<Index> stack;
+        std::vector<std::pair<Index, EdgeIndex>> calls;
+        strong_components.assign(num_vertices, UNVISITED);
+        unsigned int counter = 0;
+
+        auto enter = [&](Index index)
+        {
+            order[index] = low[index] = counter++;
+            stack.push_back(index);
+            on_stack[index] = true;
+            calls.emplace_back(index, csr.edges_begin(index));
+        };
+
+        for (Index root = 0; root < num_vertices; root++)
+        {
+            if (order[root] != UNVISITED)
+                continue;
+            enter(root);
+            while (!calls.empty())
+            {
+                Index current_index = calls.back().first;
+                EdgeIndex &edge = calls.back().second;
+                if (edge != csr.edges_end(current_index))
+                {
+                    Index neighbor_index = csr.get_target(edge++);
+                    if (order[neighbor_index] == UNVISITED)
+                        enter(neighbor_index);
+                    else if (on_stack[neighbor_index])
+                        low[current_index] = std::min(low[current_index], order[neighbor_index]);
+                    continue;
+                }
+
+                calls.pop_back();
+                if (!calls.empty())
+                {
+                    Index parent_index = calls.back().first;
+                    low[parent_index] = std::min(low[parent_index], low[current_index]);
+                }
+                if (low[current_index] == order[current_index])
+                {
+                    // The current vertex roots a component made of everything above it on the stack
+                    const unsigned int component = num_strong_components++;
+                    Index member;
+                    do
+                    {
+                        member = stack.back();
+                        stack.pop_back();
+                        on_stack[member] = false;
+                        strong_components[member] = component;
+                    } while (member != current_index);
+                }
+            }
+        }
+    }
+} // namespace graph
+
+#endif // CONNECTIVITY_H
@@ -0,0 +1,381 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <cmath>
+#include <vector>
+#include <tuple>
+#include <limits>
+#include <climits>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include "array_storage.hpp"
+#include "CGAL/Point_2.h"
+#include "CGAL/Cartesian.h"
+
+namespace graph
+{
+    // Immutable compressed-sparse-row view of a graph. Vertices are addressed by dense
+    // indices 0..N-1 assigned in ascending order of their external position, so the
+    // index -> position table doubles as a sorted lookup for position -> index.
+    template <class T>
+    class CSRGraph
+    {
+    public:
+        using ValueType = T;
+        using Index = unsigned int;
+        using EdgeIndex = std::size_t;
+        using Point = CGAL::Point_2<CGAL::Cartesian<T>>;
+        using VertexElements = std::vector<std::tuple<unsigned int, T, T>>;
+        using EdgeElements = std::vector<std::tuple<unsigned int, unsigned int, double>>;
+
+        static constexpr Index INVALID_INDEX = UINT_MAX;
+
+        // The raw arrays behind the graph, used to save and load binary snapshots
+        struct Arrays
+        {
+            ArrayStorage<unsigned int> positions;
+            ArrayStorage<T> xs;
+            ArrayStorage<T> ys;
+            ArrayStorage<EdgeIndex> offsets;
+            ArrayStorage<Index> targets;
+            ArrayStorage<double> costs;
+            ArrayStorage<EdgeIndex> reverse_offsets;
+            ArrayStorage<Index> reverse_sources;
+            ArrayStorage<EdgeIndex> reverse_edges;
+        };
+
+        CSRGraph();
+        CSRGraph(const VertexElements &vertex_elems, const EdgeElements &edge_elems);
+        explicit CSRGraph(Arrays arrays);
+
+        // Build from vertex and edge columns, edges refer to their vertices by position. The columns
+        // are consumed and released as soon as they are used, keeping peak memory near the final size.
+        CSRGraph(std::vector<unsigned int> vertex_positions, std::vector<T> vertex_xs, std::vector<T> vertex_ys,
+                 std::vector<unsigned int> edge_sources, std::vector<unsigned int> edge_targets, std::vector<double> edge_costs);
+
+        Arrays get_arrays() const;
+
+        // Sizes
+        std::size_t get_num_vertices() const;
+        std::size_t get_num_edges() const;
+        bool is_empty() const;
+
+        // Position <-> index mapping
+        Index get_index(unsigned int position) const;
+        Index find_index(unsigned int position) const;
+        unsigned int get_position(Index index) const;
+
+        // Vertex data, coordinates are stored as separate x and y arrays indexed by dense index
+        Point get_coordinates(Index index) const;
+        T get_x(Index index) const;
+        T get_y(Index index) const;
+        const T *get_x_data() const;
+        const T *get_y_data() const;
+        double get_heuristic(Index from_index, Index to_index) const;
+
+        // Adjacency, the outgoing edges of a vertex are [edges_begin, edges_end)
+        EdgeIndex edges_begin(Index index) const;
+        EdgeIndex edges_end(Index index) const;
+        Index get_target(EdgeIndex edge) const;
+        double get_cost(EdgeIndex edge) const;
+
+        // Reverse adjacency, the incoming edges of a vertex are [in_edges_begin, in_edges_end)
+        // and each one refers back to its forward edge so costs are stored only once
+        EdgeIndex in_edges_begin(Index index) const;
+        EdgeIndex in_edges_end(Index index) const;
+        Index get_source(EdgeIndex in_edge) const;
+        EdgeIndex get_forward_edge(EdgeIndex in_edge) const;
+
+    private:
+        ArrayStorage<unsigned int> positions;
+        ArrayStorage<T> xs;
+        ArrayStorage<T> ys;
+        ArrayStorage<EdgeIndex> offsets;
+        ArrayStorage<Index> targets;
+        ArrayStorage<double> costs;
+        ArrayStorage<EdgeIndex> reverse_offsets;
+        ArrayStorage<Index> reverse_sources;
+        ArrayStorage<EdgeIndex> reverse_edges;
+
+        // Element I of every tuple in elements
+        template <std::size_t I, class Elements>
+        static auto column(const Elements &elements);
+    };
+
+    template <class T>
+    inline CSRGraph<T>::CSRGraph()
+        : offsets(std::vector<EdgeIndex>(1, 0)), reverse_offsets(std::vector<EdgeIndex>(1, 0)) {}
+
+    template <class T>
+    inline CSRGraph<T>::CSRGraph(const VertexElements &vertex_elems, const EdgeElements &edge_elems)
+        : CSRGraph(column<0>(vertex_elems), column<1>(vertex_elems), column<2>(vertex_elems),
+                   column<0>(edge_elems), column<1>(edge_elems), column<2>(edge_elems)) {}
+
+    template <class T>
+    inline CSRGraph<T>::CSRGraph(std::vector<unsigned int> vertex_positions, std::vector<T> vertex_xs, std::vector<T> vertex_ys,
+                                 std::vector<unsigned int> edge_sources, std::vector<unsigned int> edge_targets, std::vector<double> edge_costs)
+    {
+        if (vertex_xs.size() != vertex_positions.size() || vertex_ys.size() != vertex_positions.size() ||
+            edge_targets.size() != edge_sources.size() || edge_costs.size() != edge_sources.size())
+        {
+            throw std::invalid_argument("Inconsistent vertex or edge column sizes");
+        }
+
+        // Order the vertices by position, the first occurrence of a duplicate wins like in Graph::add_vertex.
+        // Files usually list them in order already, in which case the columns are taken as they are.
+        if (!std::is_sorted(vertex_positions.begin(), vertex_positions.end(), std::less_equal<unsigned int>()))
+        {
+            std::vector<std::size_t> order(vertex_positions.size());
+            for (std::size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                             { return vertex_positions[a] < vertex_positions[b]; });
+
+            std::vector<unsigned int> sorted_positions;
+            std::vector<T> sorted_xs, sorted_ys;
+            sorted_positions.reserve(order.size());
+            sorted_xs.reserve(order.size());
+            sorted_ys.reserve(order.size());
+            for (auto i : order)
+            {
+                if (!sorted_positions.empty() && sorted_positions.back() == vertex_positions[i])
+                    continue;
+                sorted_positions.push_back(vertex_positions[i]);
+                sorted_xs.push_back(vertex_xs[i]);
+                sorted_ys.push_back(vertex_ys[i]);
+            }
+            vertex_positions = std::move(sorted_positions);
+            vertex_xs = std::move(sorted_xs);
+            vertex_ys = std::move(sorted_ys);
+        }
+        const std::size_t num_vertices = vertex_positions.size();
+        const std::size_t num_edges = edge_sources.size();
+        positions = std::move(vertex_positions);
+        xs = std::move(vertex_xs);
+        ys = std::move(vertex_ys);
+
+        // Count the out-degree of every vertex, then prefix sum into offsets. The source column is
+        // turned into indices in place.
+        std::vector<EdgeIndex> edge_offsets(num_vertices + 1, 0);
+        for (auto &source : edge_sources)
+        {
+            source = get_index(source);
+            edge_offsets[source + 1]++;
+        }
+        for (std::size_t i = 1; i < edge_offsets.size(); i++)
+            edge_offsets[i] += edge_offsets[i - 1];
+
+        // Scatter the edges, keeping the input order within each vertex, then release the input columns
+        std::vector<EdgeIndex> next(edge_offsets.begin(), edge_offsets.end() - 1);
+        std::vector<Index> out_targets(num_edges);
+        std::vector<double> out_costs(num_edges);
+        for (std::size_t i = 0; i < num_edges; i++)
+        {
+            EdgeIndex slot = next[edge_sources[i]]++;
+            out_targets[slot] = get_index(edge_targets[i]);
+            out_costs[slot] = edge_costs[i];
+        }
+        std::vector<unsigned int>().swap(edge_sources);
+        std::vector<unsigned int>().swap(edge_targets);
+        std::vector<double>().swap(edge_costs);
+
+        // Reverse arrays, the same counting sort bucketed by target instead of source
+        std::vector<EdgeIndex> in_offsets(num_vertices + 1, 0);
+        for (auto target : out_targets)
+            in_offsets[target + 1]++;
+        for (std::size_t i = 1; i < in_offsets.size(); i++)
+            in_offsets[i] += in_offsets[i - 1];
+
+        next.assign(in_offsets.begin(), in_offsets.end() - 1);
+        std::vector<Index> in_sources(num_edges);
+        std::vector<EdgeIndex> in_edges(num_edges);
+        for (Index v = 0; v < num_vertices; v++)
+        {
+            for (EdgeIndex edge = edge_offsets[v]; edge < edge_offsets[v + 1]; edge++)
+            {
+                EdgeIndex slot = next[out_targets[edge]]++;
+                in_sources[slot] = v;
+                in_edges[slot] = edge;
+            }
+        }
+
+        offsets = std::move(edge_offsets);
+        targets = std::move(out_targets);
+        costs = std::move(out_costs);
+        reverse_offsets = std::move(in_offsets);
+        reverse_sources = std::move(in_sources);
+        reverse_edges = std::move(in_edges);
+    }
+
+    template <class T>
+    template <std::size_t I, class Elements>
+    inline auto CSRGraph<T>::column(const Elements &elements)
+    {
+        std::vector<std::tuple_element_t<I, typename Elements::value_type>> values;
+        values.reserve(elements.size());
+        for (const auto &element : elements)
+            values.push_back(std::get<I>(element));
+        return values;
+    }
+
+    template <class T>
+    inline CSRGraph<T>::CSRGraph(Arrays arrays)
+        : positions(std::move(arrays.positions)), xs(std::move(arrays.xs)), ys(std::move(arrays.ys)), offsets(std::move(arrays.offsets)),
+          targets(std::move(arrays.targets)), costs(std::move(arrays.costs)), reverse_offsets(std::move(arrays.reverse_offsets)),
+          reverse_sources(std::move(arrays.reverse_sources)), reverse_edges(std::move(arrays.reverse_edges))
+    {
+        // Only the sizes are checked here, parser::load_snapshot validates the contents of mapped files
+        const std::size_t num_vertices = positions.size();
+        const std::size_t num_edges = targets.size();
+        if (xs.size() != num_vertices || ys.size() != num_vertices || offsets.size() != num_vertices + 1 ||
+            reverse_offsets.size() != num_vertices + 1 || costs.size() != num_edges || reverse_sources.size() != num_edges ||
+            reverse_edges.size() != num_edges || offsets.back() != num_edges || reverse_offsets.back() != num_edges)
+        {
+            throw std::invalid_argument("Inconsistent CSR array sizes");
+        }
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Arrays CSRGraph<T>::get_arrays() const
+    {
+        return Arrays{positions, xs, ys, offsets, targets, costs, reverse_offsets, reverse_sources, reverse_edges};
+    }
+
+    template <class T>
+    inline std::size_t CSRGraph<T>::get_num_vertices() const
+    {
+        return positions.size();
+    }
+
+    template <class T>
+    inline std::size_t CSRGraph<T>::get_num_edges() const
+    {
+        return targets.size();
+    }
+
+    template <class T>
+    inline bool CSRGraph<T>::is_empty() const
+    {
+        return positions.empty();
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Index CSRGraph<T>::get_index(unsigned int position) const
+    {
+        Index index = find_index(position);
+        if (index == INVALID_INDEX)
+        {
+            throw std::out_of_range("Vertex position not found");
+        }
+        return index;
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Index CSRGraph<T>::find_index(unsigned int position) const
+    {
+        // Positions are usually 0..N-1 or 1..N, try the direct slots before searching
+        if (position < positions.size() && positions[position] == position)
+            return position;
+        if (position > 0 && position - 1 < positions.size() && positions[position - 1] == position)
+            return position - 1;
+        auto it = std::lower_bound(positions.begin(), positions.end(), position);
+        if (it == positions.end() || *it != position)
+            return INVALID_INDEX;
+        return static_cast<Index>(it - positions.begin());
+    }
+
+    template <class T>
+    inline unsigned int CSRGraph<T>::get_position(Index index) const
+    {
+        return positions[index];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Point CSRGraph<T>::get_coordinates(Index index) const
+    {
+        return Point(xs[index], ys[index]);
+    }
+
+    template <class T>
+    inline T CSRGraph<T>::get_x(Index index) const
+    {
+        return xs[index];
+    }
+
+    template <class T>
+    inline T CSRGraph<T>::get_y(Index index) const
+    {
+        return ys[index];
+    }
+
+    template <class T>
+    inline const T *CSRGraph<T>::get_x_data() const
+    {
+        return xs.data();
+    }
+
+    template <class T>
+    inline const T *CSRGraph<T>::get_y_data() const
+    {
+        return ys.data();
+    }
+
+    template <class T>
+    inline double CSRGraph<T>::get_heuristic(Index from_index, Index to_index) const
+    {
+        double dx = xs[from_index] - xs[to_index];
+        double dy = ys[from_index] - ys[to_index];
+        return static_cast<T>(std::sqrt(dx * dx + dy * dy));
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::EdgeIndex CSRGraph<T>::edges_begin(Index index) const
+    {
+        return offsets[index];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::EdgeIndex CSRGraph<T>::edges_end(Index index) const
+    {
+        return offsets[index + 1];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Index CSRGraph<T>::get_target(EdgeIndex edge) const
+    {
+        return targets[edge];
+    }
+
+    template <class T>
+    inline double CSRGraph<T>::get_cost(EdgeIndex edge) const
+    {
+        return costs[edge];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::EdgeIndex CSRGraph<T>::in_edges_begin(Index index) const
+    {
+        return reverse_offsets[index];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::EdgeIndex CSRGraph<T>::in_edges_end(Index index) const
+    {
+        return reverse_offsets[index + 1];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::Index CSRGraph<T>::get_source(EdgeIndex in_edge) const
+    {
+        return reverse_sources[in_edge];
+    }
+
+    template <class T>
+    inline typename CSRGraph<T>::EdgeIndex CSRGraph<T>::get_forward_edge(EdgeIndex in_edge) const
+    {
+        return reverse_edges[in_edge];
+    }
+} // namespace graph
+
+#endif // CSR_GRAPH_H
@@ -0,0 +1,222 @@
+#ifndef DYNAMIC_COSTS_H
+#define DYNAMIC_COSTS_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <stdexcept>
+#include "csr_graph.hpp"
+#include "../parallel/hazard.hpp"
+
+namespace graph
+{
+    // New cost for the edges from source to target, both given as vertex positions. A cost of -1 makes
+    // the edges untraversable, like in the graph files.
+    struct EdgeCostUpdate
+    {
+        unsigned int source;
+        unsigned int target;
+        double cost;
+    };
+
+    // One edge whose cost was actually changed by an update, its ends are given as dense CSR indices
+    struct EdgeCostChange
+    {
+        unsigned int source;
+        unsigned int target;
+        std::size_t edge;
+        double old_cost;
+        double new_cost;
+    };
+
+    // One published set of edge costs, never modified once readers can see it
+    struct CostVersion
+    {
+        std::uint64_t number;
+        std::vector<double> costs;
+    };
+
+    // A pinned cost version, indexed like the CSR edges. The version stays alive and unchanged for as
+    // long as the snapshot exists, whatever writers publish in the meantime.
+    class CostSnapshot
+    {
+    public:
+        CostSnapshot() = default;
+
+        double get_cost(std::size_t edge) const;
+        std::uint64_t get_version() const;
+
+    private:
+        template <class T>
+        friend class DynamicCosts;
+
+        explicit CostSnapshot(parallel::HazardDomain<CostVersion>::Guard guard);
+
+        parallel::HazardDomain<CostVersion>::Guard guard;
+        const double *costs = nullptr;
+    };
+
+    // Mutable edge costs over the immutable topology of a CSRGraph, safe to update while queries run.
+    // Writers copy the current costs, apply their batch and publish the copy with one atomic store;
+    // readers pin whichever version is current for a whole query without taking a lock, and see either
+    // all of a batch or none of it. Old versions are freed once the last snapshot of them is gone.
+    //
+    // The layer keeps its own copy of the CSR, which shares the arrays of the original. Every snapshot
+    // must be released before the layer is destroyed.
+    template <class T>
+    class DynamicCosts
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+
+        // Start from the costs stored in the graph, or from those of a snapshot of the same graph
+        explicit DynamicCosts(const CSRGraph<T> &csr);
+        DynamicCosts(const CSRGraph<T> &csr, const CostSnapshot &initial);
+        ~DynamicCosts();
+
+        DynamicCosts(const DynamicCosts &) = delete;
+        DynamicCosts &operator=(const DynamicCosts &) = delete;
+
+        const CSRGraph<T> &get_csr() const;
+
+        // Reader side: pin the current version
+        CostSnapshot pin() const;
+        std::uint64_t get_version() const;
+
+        // Writer side: apply a batch of updates and publish it as a new version. Every parallel edge
+        // from source to target gets the new cost, and the edges whose cost changed are returned in the
+        // order they were changed. Nothing is published if any update names a pair of vertices that is
+        // not connected or if no cost changes. When published is given it is pinned to the version the
+        // batch produced, or to the current one if there was nothing to publish.
+        std::vector<EdgeCostChange> update_costs(const std::vector<EdgeCostUpdate> &updates, CostSnapshot *published = nullptr);
+
+        // Versions replaced by a writer but still pinned by a reader
+        std::size_t get_num_retired() const;
+
+    private:
+        CSRGraph<T> csr;
+        std::atomic<CostVersion *> current;
+        mutable parallel::HazardDomain<CostVersion> versions;
+        mutable std::mutex writer_mutex;
+    };
+
+    inline CostSnapshot::CostSnapshot(parallel::HazardDomain<CostVersion>::Guard guard)
+        : guard(std::move(guard)), costs(this->guard.get()->costs.data()) {}
+
+    inline double CostSnapshot::get_cost(std::size_t edge) const
+    {
+        return costs[edge];
+    }
+
+    inline std::uint64_t CostSnapshot::get_version() const
+    {
+        return guard.get()->number;
+    }
+
+    template <class T>
+    inline DynamicCosts<T>::DynamicCosts(const CSRGraph<T> &csr) : csr(csr)
+    {
+        auto version = new CostVersion{1, std::vector<double>(csr.get_num_edges())};
+        for (EdgeIndex edge = 0; edge < version->costs.size(); edge++)
+            version->costs[edge] = csr.get_cost(edge);
+        current.store(version);
+    }
+
+    template <class T>
+    inline DynamicCosts<T>::DynamicCosts(const CSRGraph<T> &csr, const CostSnapshot &initial) : csr(csr)
+    {
+        auto version = new CostVersion{1, std::vector<double>(csr.get_num_edges())};
+        for (EdgeIndex edge = 0; edge < version->costs.size(); edge++)
+            version->costs[edge] = initial.get_cost(edge);
+        current.store(version);
+    }
+
+    template <class T>
+    inline DynamicCosts<T>::~DynamicCosts()
+    {
+        delete current.load();
+    }
+
+    template <class T>
+    inline const CSRGraph<T> &DynamicCosts<T>::get_csr() const
+    {
+        return csr;
+    }
+
+    template <class T>
+    inline CostSnapshot DynamicCosts<T>::pin() const
+    {
+        return CostSnapshot(versions.protect(current));
+    }
+
+    template <class T>
+    inline std::uint64_t DynamicCosts<T>::get_version() const
+    {
+        return pin().get_version();
+    }
+
+    template <class T>
+    inline std::vector<EdgeCostChange> DynamicCosts<T>::update_costs(const std::vector<EdgeCostUpdate> &updates, CostSnapshot *published)
+    {
+        // Validate the whole batch first so a bad update cannot leave it half applied
+        for (const auto &update : updates)
+        {
+            Index source = csr.get_index(update.source);
+            Index target = csr.get_index(update.target);
+            bool found = false;
+            for (EdgeIndex edge = csr.edges_begin(source); edge != csr.edges_end(source) && !found; edge++)
+                found = csr.get_target(edge) == target;
+            if (!found)
+                throw std::out_of_range("No edge from vertex " + std::to_string(update.source) + " to vertex " + std::to_string(update.target));
+        }
+
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        CostVersion *old_version = current.load();
+        std::vector<EdgeCostChange> changes;
+        for (const auto &update : updates)
+        {
+            Index source = csr.get_index(update.source);
+            Index target = csr.get_index(update.target);
+            for (EdgeIndex edge = csr.edges_begin(source); edge != csr.edges_end(source); edge++)
+            {
+                if (csr.get_target(edge) == target)
+                    changes.push_back(EdgeCostChange{source, target, edge, 0, update.cost});
+            }
+        }
+
+        // Updates apply in order on a private copy, those that leave a cost as it was are dropped
+        std::vector<double> costs(old_version->costs);
+        std::size_t kept = 0;
+        for (auto &change : changes)
+        {
+            change.old_cost = costs[change.edge];
+            if (change.old_cost != change.new_cost)
+            {
+                costs[change.edge] = change.new_cost;
+                changes[kept++] = change;
+            }
+        }
+        changes.resize(kept);
+
+        if (!changes.empty())
+        {
+            current.store(new CostVersion{old_version->number + 1, std::move(costs)});
+            versions.retire(old_version);
+        }
+        if (published)
+            *published = pin();
+        return changes;
+    }
+
+    template <class T>
+    inline std::size_t DynamicCosts<T>::get_num_retired() const
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        return versions.get_num_retired();
+    }
+} // namespace graph
+
+#endif // DYNAMIC_COSTS_H
@@ -23,12 +23,12 @@ namespace graph
         ~Edge();
 
         // Getter methods
-        VertexPtr get_source();
-        VertexPtr get_destination();
-        ValueType get_length();
-        double get_cost();
-        bool is_connected(VertexPtr v);
-        bool is_valid();
+        VertexPtr get_source() const;
+        VertexPtr get_destination() const;
+        ValueType get_length() const;
+        double get_cost() const;
+        bool is_connected(VertexPtr v) const;
+        bool is_valid() const;
 
         // Other utility methods
         void set_source(VertexPtr src);
@@ -39,10 +39,10 @@ namespace graph
         void update_cost(double new_cost);
 
         // Comparison operators
-        bool operator==(const Edge<T> &other);
-        bool operator!=(const Edge<T> &other);
-        bool operator<(const Edge<T> &other);
-        bool operator>(const Edge<T> &other);
+        bool operator==(const Edge<T> &other) const;
+        bool operator!=(const Edge<T> &other) const;
+        bool operator<(const Edge<T> &other) const;
+        bool operator>(const Edge<T> &other) const;
 
         // Convert the Edge to a string representation
         std::string to_string() const;
@@ -93,25 +93,25 @@ namespace graph
 
     // Implementation of getter methods
     template <class T>
-    inline Vertex<T> *Edge<T>::get_source()
+    inline Vertex<T> *Edge<T>::get_source() const
     {
         return source;
     }
 
     template <class T>
-    inline Vertex<T> *Edge<T>::get_destination()
+    inline Vertex<T> *Edge<T>::get_destination() const
     {
         return destination;
     }
 
     template <class T>
-    inline double Edge<T>::get_cost()
+    inline double Edge<T>::get_cost() const
     {
         return cost;
     }
 
     template <class T>
-    inline typename Edge<T>::ValueType Edge<T>::get_length()
+    inline typename Edge<T>::ValueType Edge<T>::get_length() const
     {
         return T(CGAL::sqrt(CGAL::squared_distance(
             source->get_coordinates(),
@@ -132,38 +132,38 @@ namespace graph
     }
 
     template <class T>
-    inline bool Edge<T>::is_valid()
+    inline bool Edge<T>::is_valid() const
     {
         return source != nullptr && destination != nullptr;
     }
 
     template <class T>
-    inline bool Edge<T>::is_connected(VertexPtr v)
+    inline bool Edge<T>::is_connected(VertexPtr v) const
     {
         return source == v || destination == v;
     }
 
     // Implementation of comparison operators
     template <class T>
-    inline bool Edge<T>::operator==(const Edge<T> &other)
+    inline bool Edge<T>::operator==(const Edge<T> &other) const
     {
         return source == other.get_source() && destination == other.get_destination() && cost == other.get_cost();
     }
 
     template <class T>
-    inline bool Edge<T>::operator!=(const Edge<T> &other)
+    inline bool Edge<T>::operator!=(const Edge<T> &other) const
     {
         return !(*this == other);
     }
 
     template <class T>
-    inline bool Edge<T>::operator<(const Edge<T> &other)
+    inline bool Edge<T>::operator<(const Edge<T> &other) const
     {
         return cost < other.get_cost();
     }
 
     template <class T>
-    inline bool Edge<T>::operator>(const Edge<T> &other)
+    inline bool Edge<T>::operator>(const Edge<T> &other) const
     {
         return cost > other.get_cost();
     }
@@ -3,11 +3,21 @@
 
 #include <iostream>
 #include <tuple>
+#include <unordered_map>
+#include <memory>
+#include <stdexcept>
 #include <assert.h>
 #include "vertex.hpp"
+#include "csr_graph.hpp"
+#include "object_pool.hpp"
+#include "dynamic_costs.hpp"
+#include "connectivity.hpp"
+#include "spatial_index.hpp"
 
 namespace graph
 {
+    // The graph owns its vertices and edges, which live in two slab pools and are released together
+    // with the graph. Graphs move cheaply and are copied only through clone().
     template <class T>
     class Graph
     {
@@ -15,11 +25,11 @@ namespace graph
     public:
         using ValueType = T;
         using VertexPtr = Vertex<T> *;
+        using EdgePtr = Edge<T> *;
         using Positions = std::vector<unsigned int>;
         using Point = typename Vertex<T>::Point;
         using Edges = typename Vertex<T>::Edges;
         using Vertices = std::unordered_map<unsigned int, VertexPtr>;
-        using Visited = std::unordered_map<VertexPtr, bool>;
         using Point_T = std::tuple<unsigned int, Point>;
         using VertexElements = std::vector<std::tuple<unsigned int, T, T>>;
         using EdgeElements = std::vector<std::tuple<unsigned int, unsigned int, double>>;
@@ -28,80 +38,164 @@ namespace graph
         using Bounds = std::tuple<T, T, T, T>;
 
         Graph();
-        Graph(Vertices vertices);
-        Graph(VertexElements vertex_elems, EdgeElements edge_elems);
+        Graph(const VertexElements &vertex_elems, const EdgeElements &edge_elems);
+        explicit Graph(CSRGraph<T> csr);
         ~Graph();
 
-        Bounds get_bounds();
-        Vertices get_vertices();
-        VertexPtr get_vertex(unsigned int position);
+        Graph(const Graph &) = delete;
+        Graph &operator=(const Graph &) = delete;
+        Graph(Graph &&) = default;
+        Graph &operator=(Graph &&) = default;
+
+        // Deep copy with its own vertices and edges
+        Graph clone() const;
+
+        Bounds get_bounds() const;
+        const Vertices &get_vertices() const;
+        const CSRGraph<T> &get_csr();
+        VertexPtr get_vertex(unsigned int position) const;
         std::size_t get_num_vertices() const;
-        Positions get_optimal_path();
-        Positions get_astar_path();
-        Positions get_dijkstra_path();
-        ValueType get_path_distance(const Positions& path);
-        Edges get_path_edges(const Positions& path);
-        EdgeElements get_path_edge_elements(const Positions& path);
-        ValueType get_distance(const VertexPtr& from_vertex, const VertexPtr& to_vertex);
-        double get_heuristic(unsigned int from_position, unsigned int to_position);
-        double get_path_cost(const Positions& path);
-
-        void set_vertices(Vertices vertices);
-        void create_vertices(VertexElements vertex_elems);
-        void create_edges(EdgeElements edge_elems);
-        void add_vertex(VertexPtr vertex);
+        const Positions &get_optimal_path() const;
+        const Positions &get_astar_path() const;
+        const Positions &get_dijkstra_path() const;
+        ValueType get_path_distance(const Positions& path) const;
+        Edges get_path_edges(const Positions& path) const;
+        EdgeElements get_path_edge_elements(const Positions& path) const;
+        ValueType get_distance(const VertexPtr& from_vertex, const VertexPtr& to_vertex) const;
+        double get_heuristic(unsigned int from_position, unsigned int to_position) const;
+        double get_path_cost(const Positions& path) const;
+
+        void create_vertices(const VertexElements &vertex_elems);
+        void create_edges(const EdgeElements &edge_elems);
+        VertexPtr add_vertex(unsigned int position, T x, T y);
+        EdgePtr add_edge(unsigned int src_position, unsigned int dest_position, double cost);
         void remove_vertex(unsigned int position);
-        bool vertex_exists(unsigned int position);
-        bool are_vertices_connected(unsigned int start_position, unsigned int end_position);
+        bool vertex_exists(unsigned int position) const;
+        template <class Visit>
+        void for_each_neighbor(unsigned int position, Visit visit) const;
         bool is_empty() const;
+
+        // Reachability over the CSR, see connectivity.hpp. The components are computed on first use
+        // and dropped whenever the CSR is rebuilt. A graph is connected when every vertex can reach
+        // every other one, and may_reach() rejects most unreachable pairs in constant time.
+        const Connectivity<T> &get_connectivity();
         bool is_connected();
+        bool may_reach(unsigned int start_position, unsigned int end_position);
+        bool are_vertices_connected(unsigned int start_position, unsigned int end_position);
+        template <class Visit>
+        void depth_first_search(unsigned int start_position, Visit visit);
+
+        // Nearest vertex, nearest edge and box lookups over the vertex coordinates, see spatial_index.hpp.
+        // Built on first use and dropped with the CSR like the components. find_nearest_vertex() returns
+        // the position of the vertex closest to (x, y) and throws on an empty graph.
+        const SpatialIndex<T> &get_spatial_index();
+        unsigned int find_nearest_vertex(double x, double y);
 
         void set_optimal_path(const Positions &path);
         void set_astar_path(const Positions &path);
         void set_dijkstra_path(const Positions &path);
-        void dfs_recursive(VertexPtr vertex);
-        void depth_first_search(VertexPtr start_vertex);
 
         void create_mesh(Elements elements);
-        void create_mesh(Vertices vertices, EdgeElements edge_elems);
-        void create_mesh(VertexElements vertex_elems, EdgeElements edge_elems);
-
-        void add_visited(VertexPtr vertex_ptr, bool status);
-        bool get_visited(VertexPtr vertex_ptr);
-        void clear_visited();
-
+        void create_mesh(const VertexElements &vertex_elems, const EdgeElements &edge_elems);
+
+        void build_csr();
+        void materialize();
+
+        // Edge costs that can be updated while queries run, see dynamic_costs.hpp. They start from the
+        // CSR costs when enabled, and the vertex and edge objects keep the costs the graph was built with.
+        // The layer is shared: holders of the returned pointer keep it alive after it is disabled. While
+        // it is attached the topology is frozen, so adding or removing vertices or edges throws instead
+        // of rebuilding the CSR under the published versions. The A* heuristics must stay lower bounds:
+        // the Euclidean one breaks once a cost drops below the straight-line length of its edge, and
+        // landmark tables, built from the base costs, are rejected while the layer is attached.
+        std::shared_ptr<DynamicCosts<T>> enable_cost_updates();
+        void disable_cost_updates();
+        DynamicCosts<T> *get_dynamic_costs() const;
+
+        // Call search(costs) with the costs a query should read: a snapshot of the dynamic costs pinned
+        // for the whole call when they are enabled, the CSR itself otherwise
+        template <class Search>
+        auto with_costs(Search search);
         void clear_graph();
         void print_graph();
 
     private:
-        Visited visited;
+        template <class Visit>
+        void for_each_path_edge(const Positions& path, Visit visit) const;
+        void check_topology_unfrozen() const;
+
+        ObjectPool<Vertex<T>> vertex_pool;
+        ObjectPool<Edge<T>> edge_pool;
         Vertices vertices;
+        CSRGraph<T> csr;
+        bool csr_valid = false;
+        std::shared_ptr<DynamicCosts<T>> dynamic_costs;
+        std::unique_ptr<Connectivity<T>> connectivity;
+        std::unique_ptr<SpatialIndex<T>> spatial_index;
         Positions astar_path;
         Positions dijkstra_path;
         Positions optimal_path;
-        std::size_t edge_count;
     };
 
     template <class T>
     inline Graph<T>::Graph() {}
 
     template <class T>
-    inline Graph<T>::Graph(Vertices vertices)
+    inline Graph<T>::Graph(const VertexElements &vertex_elems, const EdgeElements &edge_elems)
     {
-        this->vertices = vertices;
+        create_mesh(vertex_elems, edge_elems);
     }
 
+    // Serve the graph from a prebuilt CSR (for instance a mapped snapshot). Only the CSR exists until
+    // materialize() creates the vertex and edge objects needed by the display and the path queries.
     template <class T>
-    inline Graph<T>::Graph(VertexElements vertex_elems, EdgeElements edge_elems)
-    {
-        create_mesh(vertex_elems, edge_elems);
-    }
+    inline Graph<T>::Graph(CSRGraph<T> csr) : csr(std::move(csr)), csr_valid(true) {}
 
     template <class T>
     inline Graph<T>::~Graph() {}
 
     template <class T>
-    inline typename Graph<T>::Bounds Graph<T>::get_bounds()
+    inline Graph<T> Graph<T>::clone() const
+    {
+        Graph<T> copy;
+        copy.vertex_pool.reserve(vertices.size());
+        std::unordered_map<const Vertex<T> *, VertexPtr> copies;
+        auto copy_of = [&](VertexPtr vertex)
+        {
+            auto it = copies.find(vertex);
+            if (it != copies.end())
+                return it->second;
+            VertexPtr created = copy.vertex_pool.create(vertex->get_position(), vertex->get_coordinates());
+            copies.emplace(vertex, created);
+            return created;
+        };
+        for (const auto &vertex : vertices)
+            copy.vertices.emplace(vertex.first, copy_of(vertex.second));
+        for (const auto &vertex : vertices)
+        {
+            for (const auto &edge : vertex.second->get_edges())
+            {
+                // Edges to removed vertices keep a private copy of their destination
+                auto created = copy.edge_pool.create(copy_of(edge->get_source()), copy_of(edge->get_destination()), edge->get_cost());
+                copies.at(vertex.second)->add_edge(created);
+            }
+        }
+        copy.csr = csr;
+        copy.csr_valid = csr_valid;
+        if (dynamic_costs)
+            copy.dynamic_costs = std::make_shared<DynamicCosts<T>>(csr, dynamic_costs->pin());
+        if (connectivity)
+            copy.connectivity = std::make_unique<Connectivity<T>>(*connectivity);
+        if (spatial_index)
+            copy.spatial_index = std::make_unique<SpatialIndex<T>>(*spatial_index);
+        copy.astar_path = astar_path;
+        copy.dijkstra_path = dijkstra_path;
+        copy.optimal_path = optimal_path;
+        return copy;
+    }
+
+    template <class T>
+    inline typename Graph<T>::Bounds Graph<T>::get_bounds() const
     {
         if (vertices.empty())
         {
@@ -134,16 +228,25 @@ namespace graph
     }
 
     template <class T>
-    inline typename Graph<T>::Vertices Graph<T>::get_vertices()
+    inline const typename Graph<T>::Vertices &Graph<T>::get_vertices() const
     {
         return vertices;
     }
 
     template <class T>
-    inline typename Graph<T>::VertexPtr Graph<T>::get_vertex(unsigned int position)
+    inline const CSRGraph<T> &Graph<T>::get_csr()
+    {
+        if (!csr_valid)
+            build_csr();
+        return csr;
+    }
+
+    template <class T>
+    inline typename Graph<T>::VertexPtr Graph<T>::get_vertex(unsigned int position) const
     {
-        if (vertex_exists(position)) {
-            return vertices[position];
+        auto it = vertices.find(position);
+        if (it != vertices.end()) {
+            return it->second;
         }
         else
         {
@@ -151,90 +254,110 @@ namespace graph
         }
     }
 
+    // Adding a position that already exists keeps and returns the existing vertex
     template <class T>
-    inline void Graph<T>::set_vertices(Vertices vertices)
+    inline typename Graph<T>::VertexPtr Graph<T>::add_vertex(unsigned int position, T x, T y)
     {
-        this->vertices = vertices;
+        check_topology_unfrozen();
+        auto it = vertices.find(position);
+        if (it != vertices.end())
+            return it->second;
+        VertexPtr vertex = vertex_pool.create(position, x, y);
+        vertices.emplace(position, vertex);
+        csr_valid = false;
+        return vertex;
     }
 
     template <class T>
-    inline void Graph<T>::add_vertex(VertexPtr vertex)
+    inline typename Graph<T>::EdgePtr Graph<T>::add_edge(unsigned int src_position, unsigned int dest_position, double cost)
     {
-        unsigned int position = vertex->get_position();
-        vertices.emplace(position, vertex);
+        check_topology_unfrozen();
+        auto src = get_vertex(src_position);
+        auto dest = get_vertex(dest_position);
+        EdgePtr edge = edge_pool.create(src, dest, cost);
+        src->add_edge(edge);
+        csr_valid = false;
+        return edge;
     }
 
+    // The vertex leaves the graph, its memory is reclaimed with the rest of the pool
     template <class T>
     inline void Graph<T>::remove_vertex(unsigned int position)
     {
+        check_topology_unfrozen();
         vertices.erase(position);
+        csr_valid = false;
     }
 
     template <class T>
-    inline bool Graph<T>::vertex_exists(unsigned int position)
+    inline bool Graph<T>::vertex_exists(unsigned int position) const
     {
         return vertices.find(position) != vertices.end();
     }
 
     template <class T>
-    inline typename Graph<T>::EdgeElements Graph<T>::get_path_edge_elements(const Positions& path) {
-        EdgeElements path_edges;
-        for (unsigned int i = 0; i < path.size() - 1; i++){
-            auto vertex = get_vertex(path[i]);
-            for (auto& edge: vertex->get_edges()) {
-                auto neighbor_pos = edge->get_destination()->get_position();
-                if (neighbor_pos == path[i + 1])
-                    path_edges.emplace_back(path[i], path[i + 1], edge->get_cost());
+    template <class Visit>
+    inline void Graph<T>::for_each_neighbor(unsigned int position, Visit visit) const
+    {
+        get_vertex(position)->for_each_neighbor(visit);
+    }
+
+    // Call visit(edge) for every edge joining consecutive vertices of the path
+    template <class T>
+    template <class Visit>
+    inline void Graph<T>::for_each_path_edge(const Positions& path, Visit visit) const
+    {
+        for (std::size_t i = 0; i + 1 < path.size(); i++) {
+            for (EdgePtr edge : get_vertex(path[i])->get_edges()) {
+                if (edge->get_destination()->get_position() == path[i + 1])
+                    visit(edge);
             }
         }
+    }
+
+    template <class T>
+    inline typename Graph<T>::EdgeElements Graph<T>::get_path_edge_elements(const Positions& path) const {
+        EdgeElements path_edges;
+        for_each_path_edge(path, [&](EdgePtr edge)
+                           { path_edges.emplace_back(edge->get_source()->get_position(), edge->get_destination()->get_position(), edge->get_cost()); });
         return path_edges;
     }
 
     template <class T>
-    inline typename Graph<T>::Edges Graph<T>::get_path_edges(const Positions& path) {
+    inline typename Graph<T>::Edges Graph<T>::get_path_edges(const Positions& path) const {
         Edges path_edges;
-        for (unsigned int i = 0; i < path.size() - 1; i++){
-            auto vertex = get_vertex(path[i]);
-            for (auto& edge: vertex->get_edges()) {
-                auto neighbor_pos = edge->get_destination()->get_position();
-                if (neighbor_pos == path[i + 1])
-                    path_edges.emplace_back(edge);
-            }
-        }
+        for_each_path_edge(path, [&](EdgePtr edge)
+                           { path_edges.emplace_back(edge); });
         return path_edges;
     }
 
     template <class T>
-    inline typename Graph<T>::ValueType Graph<T>::get_distance(const VertexPtr& from_vertex, const VertexPtr& to_vertex)
+    inline typename Graph<T>::ValueType Graph<T>::get_distance(const VertexPtr& from_vertex, const VertexPtr& to_vertex) const
     {
         double squared_dist = CGAL::squared_distance(from_vertex->get_coordinates(), to_vertex->get_coordinates());
         return static_cast<typename Graph<T>::ValueType>(std::sqrt(squared_dist));
     }
 
     template <class T>
-    inline typename Graph<T>::ValueType Graph<T>::get_path_distance(const Positions& path)
+    inline typename Graph<T>::ValueType Graph<T>::get_path_distance(const Positions& path) const
     {
         T path_distance = 0;
-        Edges edges = get_path_edges(path);
-        for (auto& edge : edges) {
-            path_distance += edge->get_length();
-        }
+        for_each_path_edge(path, [&](EdgePtr edge)
+                           { path_distance += edge->get_length(); });
         return path_distance;
     }
 
     template <class T>
-    inline double Graph<T>::get_path_cost(const Positions& path)
+    inline double Graph<T>::get_path_cost(const Positions& path) const
     {
         double path_cost = 0;
-        Edges edges = get_path_edges(path);
-        for (auto& edge : edges) {
-            path_cost += edge->get_cost();
-        }
+        for_each_path_edge(path, [&](EdgePtr edge)
+                           { path_cost += edge->get_cost(); });
         return path_cost;
     }
 
     template<class T>
-    inline double Graph<T>::get_heuristic(unsigned int from_position, unsigned int to_position)
+    inline double Graph<T>::get_heuristic(unsigned int from_position, unsigned int to_position) const
     {
         const auto& from_vertex = get_vertex(from_position);
         const auto& to_vertex = get_vertex(to_position);
@@ -244,70 +367,96 @@ namespace graph
     template <class T>
     inline bool Graph<T>::is_empty() const
     {
-        return vertices.empty();
+        return vertices.empty() && (!csr_valid || csr.is_empty());
     }
 
     template <class T>
     inline std::size_t Graph<T>::get_num_vertices() const
     {
-        return vertices.size();
+        return vertices.empty() && csr_valid ? csr.get_num_vertices() : vertices.size();
+    }
+
+    template <class T>
+    inline const Connectivity<T> &Graph<T>::get_connectivity()
+    {
+        const CSRGraph<T> &graph_csr = get_csr();
+        if (!connectivity)
+            connectivity = std::make_unique<Connectivity<T>>(graph_csr);
+        return *connectivity;
+    }
+
+    template <class T>
+    inline const SpatialIndex<T> &Graph<T>::get_spatial_index()
+    {
+        const CSRGraph<T> &graph_csr = get_csr();
+        if (!spatial_index)
+            spatial_index = std::make_unique<SpatialIndex<T>>(graph_csr);
+        return *spatial_index;
+    }
+
+    template <class T>
+    inline unsigned int Graph<T>::find_nearest_vertex(double x, double y)
+    {
+        auto index = get_spatial_index().nearest_vertex(x, y);
+        if (index == CSRGraph<T>::INVALID_INDEX)
+            throw std::out_of_range("No vertex to snap to in an empty graph");
+        return csr.get_position(index);
     }
 
     template <class T>
     inline bool Graph<T>::is_connected()
     {
-        if (vertices.empty())
-        {
-            return true;
-        }
-        for (const auto &vertex : vertices)
-        {
-            visited[vertex.second] = false;
-        }
-        auto start_vertex = vertices.begin()->second;
-        dfs_recursive(start_vertex);
-        for (const auto &vertex : vertices)
-        {
-            if (!visited[vertex.second])
-            {
-                return false;
-            }
-        }
-        return true;
+        return get_connectivity().get_num_strong_components() <= 1;
+    }
+
+    template <class T>
+    inline bool Graph<T>::may_reach(unsigned int start_position, unsigned int end_position)
+    {
+        const Connectivity<T> &components = get_connectivity();
+        return components.may_reach(csr.get_index(start_position), csr.get_index(end_position));
     }
 
     template <class T>
     inline bool Graph<T>::are_vertices_connected(unsigned int start_position, unsigned int end_position)
     {
-        for (const auto &vertex : vertices)
-        {
-            visited[vertex.second] = false;
-        }
-        auto start_vertex = get_vertex(start_position);
-        auto end_vertex = get_vertex(end_position);
-        dfs_recursive(start_vertex);
-        bool connected = visited[end_vertex];
-        for (const auto &vertex : vertices)
-        {
-            visited[vertex.second] = false;
-        }
+        const Connectivity<T> &components = get_connectivity();
+        const auto start_index = csr.get_index(start_position);
+        const auto end_index = csr.get_index(end_position);
+        if (components.same_strong_component(start_index, end_index))
+            return true;
+        if (!components.may_reach(start_index, end_index))
+            return false;
+
+        // Only a search can tell between components that the condensation orders compatibly
+        bool connected = false;
+        breadth_first_search(csr, start_index, [&](auto index)
+                             { return !(connected = index == end_index); });
         return connected;
     }
 
     template <class T>
-    inline typename Graph<T>::Positions Graph<T>::get_optimal_path()
+    template <class Visit>
+    inline void Graph<T>::depth_first_search(unsigned int start_position, Visit visit)
+    {
+        const CSRGraph<T> &graph_csr = get_csr();
+        graph::depth_first_search(graph_csr, graph_csr.get_index(start_position), [&](auto index)
+                                  { visit(graph_csr.get_position(index)); return true; });
+    }
+
+    template <class T>
+    inline const typename Graph<T>::Positions &Graph<T>::get_optimal_path() const
     {
         return optimal_path;
     }
 
     template <class T>
-    inline typename Graph<T>::Positions Graph<T>::get_astar_path()
+    inline const typename Graph<T>::Positions &Graph<T>::get_astar_path() const
     {
         return astar_path;
     }
 
     template <class T>
-    inline typename Graph<T>::Positions Graph<T>::get_dijkstra_path()
+    inline const typename Graph<T>::Positions &Graph<T>::get_dijkstra_path() const
     {
         return dijkstra_path;
     }
@@ -331,38 +480,55 @@ namespace graph
     }
 
     template <class T>
-    inline void Graph<T>::dfs_recursive(VertexPtr vertex)
+    inline std::shared_ptr<DynamicCosts<T>> Graph<T>::enable_cost_updates()
     {
-        vertex->print_coordinates();
-        visited[vertex] = true;
-        for (const auto &edge : vertex->get_edges())
-        {
-            VertexPtr neighbor = (edge->get_source() == vertex) ? edge->get_destination() : edge->get_source();
-            if (!visited[neighbor])
-            {
-                dfs_recursive(neighbor);
-            }
-        }
+        const CSRGraph<T> &graph_csr = get_csr();
+        if (!dynamic_costs)
+            dynamic_costs = std::make_shared<DynamicCosts<T>>(graph_csr);
+        return dynamic_costs;
     }
 
     template <class T>
-    inline void Graph<T>::depth_first_search(VertexPtr start_vertex)
+    inline void Graph<T>::disable_cost_updates()
     {
-        for (const auto &vertex : vertices)
+        dynamic_costs.reset();
+    }
+
+    template <class T>
+    inline void Graph<T>::check_topology_unfrozen() const
+    {
+        // Edge indices change with the CSR, the published cost versions would no longer match it
+        if (dynamic_costs)
+            throw std::runtime_error("Cannot change the vertices or edges while cost updates are enabled, call disable_cost_updates() first");
+    }
+
+    template <class T>
+    inline DynamicCosts<T> *Graph<T>::get_dynamic_costs() const
+    {
+        return dynamic_costs.get();
+    }
+
+    template <class T>
+    template <class Search>
+    inline auto Graph<T>::with_costs(Search search)
+    {
+        const CSRGraph<T> &graph_csr = get_csr();
+        if (dynamic_costs)
         {
-            visited[vertex.second] = false;
+            const CostSnapshot snapshot = dynamic_costs->pin();
+            return search(snapshot);
         }
-        dfs_recursive(start_vertex);
+        return search(graph_csr);
     }
 
     template <class T>
     inline void Graph<T>::clear_graph()
     {
-        for (const auto &vertex : vertices)
-        {
-            delete vertex.second;
-        }
+        check_topology_unfrozen();
         vertices.clear();
+        edge_pool.clear();
+        vertex_pool.clear();
+        csr_valid = false;
     }
 
     template <class T>
@@ -388,7 +554,7 @@ namespace graph
             }
             else
             {
-                src_vertex = new Vertex<T>(src_pos, src_coors);
+                src_vertex = vertex_pool.create(src_pos, src_coors);
                 vertices[src_pos] = src_vertex;
             }
 
@@ -401,71 +567,90 @@ namespace graph
             }
             else
             {
-                dest_vertex = new Vertex<T>(dest_pos, dest_coors);
+                dest_vertex = vertex_pool.create(dest_pos, dest_coors);
                 vertices[dest_pos] = dest_vertex;
             }
-            auto edge = new Edge<T>(src_vertex, dest_vertex, edge_cost);
+            auto edge = edge_pool.create(src_vertex, dest_vertex, edge_cost);
             src_vertex->add_edge(edge);
         }
+        csr_valid = false;
     }
 
     template <class T>
-    inline void Graph<T>::create_mesh(Vertices vertices, EdgeElements edge_elems)
-    {
-        set_vertices(vertices);
-        create_edges(edge_elems);
-    }
-
-    template <class T>
-    inline void Graph<T>::create_mesh(VertexElements vertex_elems, EdgeElements edge_elements)
+    inline void Graph<T>::create_mesh(const VertexElements &vertex_elems, const EdgeElements &edge_elements)
     {
+        check_topology_unfrozen();
         create_vertices(vertex_elems);
         create_edges(edge_elements);
+        csr = CSRGraph<T>(vertex_elems, edge_elements);
+        csr_valid = true;
+        connectivity.reset();
+        spatial_index.reset();
     }
 
     template <class T>
-    inline void Graph<T>::add_visited(VertexPtr vertex_ptr, bool status)
-    {
-        visited[vertex_ptr] = status;
-    }
-
-    template <class T>
-    inline void Graph<T>::clear_visited()
+    inline void Graph<T>::create_vertices(const VertexElements &vertex_elems)
     {
-        visited.clear();
+        vertex_pool.reserve(vertex_elems.size());
+        for (const auto &element : vertex_elems)
+        {
+            auto p = std::get<0>(element);
+            auto x = std::get<1>(element);
+            auto y = std::get<2>(element);
+            add_vertex(p, x, y);
+        }
     }
 
     template <class T>
-    inline bool Graph<T>::get_visited(VertexPtr vertex_ptr)
+    inline void Graph<T>::create_edges(const EdgeElements &edge_elems)
     {
-        return visited[vertex_ptr];
+        edge_pool.reserve(edge_elems.size());
+        for (const auto &element : edge_elems)
+        {
+            auto src_pos = std::get<0>(element);
+            auto dest_pos = std::get<1>(element);
+            auto cost = std::get<2>(element);
+            add_edge(src_pos, dest_pos, cost);
+        }
+        csr_valid = false;
     }
 
     template <class T>
-    inline void Graph<T>::create_vertices(VertexElements vertex_elems)
+    inline void Graph<T>::build_csr()
     {
-        for (auto element : vertex_elems)
+        // Flatten the vertex map back into elements so the CSR layout is built in one place
+        VertexElements vertex_elems;
+        EdgeElements edge_elems;
+        vertex_elems.reserve(vertices.size());
+        for (const auto &vertex : vertices)
         {
-            auto p = std::get<0>(element);
-            auto x = std::get<1>(element);
-            auto y = std::get<2>(element);
-            Vertex<T> *vertex = new Vertex<T>(p, x, y);
-            add_vertex(vertex);
+            vertex_elems.emplace_back(vertex.first, vertex.second->get_x(), vertex.second->get_y());
+            for (const auto &edge : vertex.second->get_edges())
+                edge_elems.emplace_back(vertex.first, edge->get_destination()->get_position(), edge->get_cost());
         }
+        csr = CSRGraph<T>(vertex_elems, edge_elems);
+        csr_valid = true;
+        connectivity.reset();
+        spatial_index.reset();
     }
 
     template <class T>
-    inline void Graph<T>::create_edges(EdgeElements edge_elems)
+    inline void Graph<T>::materialize()
     {
-        for (auto element : edge_elems)
+        if (!vertices.empty() || !csr_valid)
+            return;
+        std::vector<VertexPtr> by_index(csr.get_num_vertices());
+        vertex_pool.reserve(csr.get_num_vertices());
+        edge_pool.reserve(csr.get_num_edges());
+        for (unsigned int index = 0; index < csr.get_num_vertices(); index++)
         {
-            auto src_pos = std::get<0>(element);
-            auto dest_pos = std::get<1>(element);
-            auto cost = std::get<2>(element);
-            auto src = get_vertex(src_pos);
-            auto dest = get_vertex(dest_pos);
-            auto edge = new Edge<T>(src, dest, cost);
-            src->add_edge(edge);
+            by_index[index] = vertex_pool.create(csr.get_position(index), csr.get_x(index), csr.get_y(index));
+            vertices.emplace(csr.get_position(index), by_index[index]);
+        }
+        for (unsigned int index = 0; index < csr.get_num_vertices(); index++)
+        {
+            for (auto edge = csr.edges_begin(index); edge != csr.edges_end(index); edge++)
+                by_index[index]->add_edge(edge_pool.create(by_index[index], by_index[csr.get_target(edge)], csr.get_cost(edge)));
         }
     }
 
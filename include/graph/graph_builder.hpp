@@ -0,0 +1,120 @@
+#ifndef GRAPH_BUILDER_H
+#define GRAPH_BUILDER_H
+
+#include <vector>
+#include <algorithm>
+#include "csr_graph.hpp"
+
+namespace graph
+{
+    // Collects vertices and edges one at a time, in plain columns, and finalizes them into a CSRGraph.
+    // Nothing is stored per element beyond the values themselves, so a reader can stream a file into
+    // the builder without holding tuple vectors or vertex and edge objects.
+    template <class T>
+    class GraphBuilder
+    {
+    public:
+        void reserve_vertices(std::size_t count);
+        void reserve_edges(std::size_t count);
+
+        void add_vertex(unsigned int position, T x, T y);
+        void add_edge(unsigned int source, unsigned int target, double cost);
+
+        // Slot access for parsers that fill separate ranges of edges from several threads: resize to
+        // make room, set distinct slots concurrently, then move the filled ranges together
+        void resize_edges(std::size_t count);
+        void set_edge(std::size_t slot, unsigned int source, unsigned int target, double cost);
+        void move_edges(std::size_t first, std::size_t last, std::size_t destination);
+
+        std::size_t get_num_vertices() const;
+        std::size_t get_num_edges() const;
+
+        // Finalize the graph, the builder is left empty
+        CSRGraph<T> build();
+
+    private:
+        std::vector<unsigned int> positions;
+        std::vector<T> xs;
+        std::vector<T> ys;
+        std::vector<unsigned int> sources;
+        std::vector<unsigned int> targets;
+        std::vector<double> costs;
+    };
+
+    template <class T>
+    inline void GraphBuilder<T>::reserve_vertices(std::size_t count)
+    {
+        positions.reserve(count);
+        xs.reserve(count);
+        ys.reserve(count);
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::reserve_edges(std::size_t count)
+    {
+        sources.reserve(count);
+        targets.reserve(count);
+        costs.reserve(count);
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::add_vertex(unsigned int position, T x, T y)
+    {
+        positions.push_back(position);
+        xs.push_back(x);
+        ys.push_back(y);
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::add_edge(unsigned int source, unsigned int target, double cost)
+    {
+        sources.push_back(source);
+        targets.push_back(target);
+        costs.push_back(cost);
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::resize_edges(std::size_t count)
+    {
+        sources.resize(count);
+        targets.resize(count);
+        costs.resize(count);
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::set_edge(std::size_t slot, unsigned int source, unsigned int target, double cost)
+    {
+        sources[slot] = source;
+        targets[slot] = target;
+        costs[slot] = cost;
+    }
+
+    template <class T>
+    inline void GraphBuilder<T>::move_edges(std::size_t first, std::size_t last, std::size_t destination)
+    {
+        // Same contract as std::move, destination must not lie inside [first, last)
+        std::move(sources.begin() + first, sources.begin() + last, sources.begin() + destination);
+        std::move(targets.begin() + first, targets.begin() + last, targets.begin() + destination);
+        std::move(costs.begin() + first, costs.begin() + last, costs.begin() + destination);
+    }
+
+    template <class T>
+    inline std::size_t GraphBuilder<T>::get_num_vertices() const
+    {
+        return positions.size();
+    }
+
+    template <class T>
+    inline std::size_t GraphBuilder<T>::get_num_edges() const
+    {
+        return sources.size();
+    }
+
+    template <class T>
+    inline CSRGraph<T> GraphBuilder<T>::build()
+    {
+        return CSRGraph<T>(std::move(positions), std::move(xs), std::move(ys), std::move(sources), std::move(targets), std::move(costs));
+    }
+} // namespace graph
+
+#endif // GRAPH_BUILDER_H
@@ -0,0 +1,129 @@
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+namespace graph
+{
+    // Slab arena for objects of one type. Objects are constructed in place in large contiguous slabs,
+    // never move, and are all destroyed and released together by clear() or the destructor; there is
+    // no way to free a single object. Moving a pool hands its slabs over, so pointers stay valid.
+    template <class V>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(std::size_t slab_size = 4096);
+        ~ObjectPool();
+
+        ObjectPool(const ObjectPool &) = delete;
+        ObjectPool &operator=(const ObjectPool &) = delete;
+        ObjectPool(ObjectPool &&other) noexcept;
+        ObjectPool &operator=(ObjectPool &&other) noexcept;
+
+        template <class... Args>
+        V *create(Args &&...args);
+
+        // Make sure the next count objects are created next to each other
+        void reserve(std::size_t count);
+
+        // Destroy every object and release the slabs
+        void clear();
+
+        std::size_t size() const;
+
+    private:
+        struct Slab
+        {
+            V *objects;
+            std::size_t capacity;
+            std::size_t used;
+        };
+
+        std::vector<Slab> slabs;
+        std::size_t slab_size;
+        std::size_t count = 0;
+
+        void add_slab(std::size_t capacity);
+    };
+
+    template <class V>
+    inline ObjectPool<V>::ObjectPool(std::size_t slab_size) : slab_size(std::max<std::size_t>(slab_size, 1)) {}
+
+    template <class V>
+    inline ObjectPool<V>::~ObjectPool()
+    {
+        clear();
+    }
+
+    template <class V>
+    inline ObjectPool<V>::ObjectPool(ObjectPool &&other) noexcept
+        : slabs(std::move(other.slabs)), slab_size(other.slab_size), count(std::exchange(other.count, 0))
+    {
+        other.slabs.clear();
+    }
+
+    template <class V>
+    inline ObjectPool<V> &ObjectPool<V>::operator=(ObjectPool &&other) noexcept
+    {
+        if (this != &other)
+        {
+            clear();
+            slabs = std::move(other.slabs);
+            other.slabs.clear();
+            slab_size = other.slab_size;
+            count = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+    template <class V>
+    template <class... Args>
+    inline V *ObjectPool<V>::create(Args &&...args)
+    {
+        if (slabs.empty() || slabs.back().used == slabs.back().capacity)
+            add_slab(slab_size);
+        Slab &slab = slabs.back();
+        V *object = ::new (static_cast<void *>(slab.objects + slab.used)) V(std::forward<Args>(args)...);
+        slab.used++;
+        count++;
+        return object;
+    }
+
+    template <class V>
+    inline void ObjectPool<V>::reserve(std::size_t count)
+    {
+        if (slabs.empty() || slabs.back().capacity - slabs.back().used < count)
+            add_slab(std::max(count, slab_size));
+    }
+
+    template <class V>
+    inline void ObjectPool<V>::clear()
+    {
+        std::allocator<V> allocator;
+        for (auto &slab : slabs)
+        {
+            std::destroy_n(slab.objects, slab.used);
+            allocator.deallocate(slab.objects, slab.capacity);
+        }
+        slabs.clear();
+        count = 0;
+    }
+
+    template <class V>
+    inline std::size_t ObjectPool<V>::size() const
+    {
+        return count;
+    }
+
+    template <class V>
+    inline void ObjectPool<V>::add_slab(std::size_t capacity)
+    {
+        slabs.reserve(slabs.size() + 1); // Grow the list first so the new slab cannot leak
+        slabs.push_back(Slab{std::allocator<V>().allocate(capacity), capacity, 0});
+    }
+} // namespace graph
+
+#endif // OBJECT_POOL_H
@@ -0,0 +1,403 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cmath>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <numeric>
+#include <cstdint>
+#include <algorithm>
+#include "csr_graph.hpp"
+
+namespace graph
+{
+    // Axis-aligned rectangle, both corners included
+    struct BoundingBox
+    {
+        double min_x;
+        double min_y;
+        double max_x;
+        double max_y;
+
+        bool intersects(const BoundingBox &other) const;
+        // Squared distance from a point to the box, 0 inside it
+        double get_squared_distance(double x, double y) const;
+    };
+
+    namespace detail
+    {
+        // Static R-tree packed bottom-up from items sorted along a Hilbert curve. Every level is stored
+        // after the one below it in a single array, so the tree is a handful of flat vectors that are
+        // built in O(n log n) and never change. Items are identified by their index in the input.
+        class PackedRTree
+        {
+        public:
+            static constexpr std::size_t NODE_SIZE = 16;
+
+            PackedRTree() = default;
+            explicit PackedRTree(const std::vector<BoundingBox> &items);
+
+            bool is_empty() const;
+
+            // visit(item) for every item whose box intersects the box
+            template <class Visit>
+            void search(const BoundingBox &box, Visit visit) const;
+
+            // visit(item, squared_distance) for the items in increasing order of distance to the point
+            // until it returns false. distance(item) is the exact squared distance to an item, which the
+            // item's box bounds from below. Items at the same distance come lowest index first.
+            template <class Distance, class Visit>
+            void nearest(double x, double y, Distance distance, Visit visit) const;
+
+        private:
+            std::size_t num_items = 0;
+            std::vector<BoundingBox> boxes;   // Items in Hilbert order, then the nodes level by level
+            std::vector<std::size_t> indices; // Input index of an item, first child of a node
+            std::vector<std::size_t> level_ends;
+
+            static std::uint64_t get_hilbert_value(std::uint32_t x, std::uint32_t y);
+            std::size_t get_children_end(std::size_t node, std::size_t level) const;
+        };
+    } // namespace detail
+
+    // Nearest vertex and nearest edge lookups, k nearest vertices and box queries over the coordinates
+    // of a CSR graph, so coordinate queries are snapped to the graph without scanning every vertex.
+    // The index keeps its own (shared) copy of the CSR and stays valid as long as nothing rebuilds it.
+    template <class T>
+    class SpatialIndex
+    {
+    public:
+        using Index = typename CSRGraph<T>::Index;
+        using EdgeIndex = typename CSRGraph<T>::EdgeIndex;
+
+        // Closest point of an edge to a query point. fraction runs from 0 at the source to 1 at the
+        // target. An empty graph has no edge and leaves the source at INVALID_INDEX.
+        struct EdgeSnap
+        {
+            Index source_index = CSRGraph<T>::INVALID_INDEX;
+            Index target_index = CSRGraph<T>::INVALID_INDEX;
+            EdgeIndex edge = 0;
+            double x = 0;
+            double y = 0;
+            double fraction = 0;
+            double distance = std::numeric_limits<double>::infinity();
+        };
+
+        SpatialIndex() = default;
+        explicit SpatialIndex(const CSRGraph<T> &csr);
+
+        // Dense index of the closest vertex, INVALID_INDEX for an empty graph
+        Index nearest_vertex(double x, double y) const;
+        // Up to k closest vertices, closest first
+        std::vector<Index> nearest_vertices(double x, double y, std::size_t k) const;
+        EdgeSnap nearest_edge(double x, double y) const;
+
+        // Vertices inside the box and edges whose segment bounding box intersects it, in index order
+        std::vector<Index> vertices_in_box(const BoundingBox &box) const;
+        std::vector<EdgeIndex> edges_in_box(const BoundingBox &box) const;
+
+    private:
+        CSRGraph<T> csr;
+        std::vector<Index> edge_sources;
+        detail::PackedRTree vertex_tree;
+        detail::PackedRTree edge_tree;
+
+        double get_squared_distance(Index index, double x, double y) const;
+        EdgeSnap project(EdgeIndex edge, double x, double y) const;
+    };
+
+    inline bool BoundingBox::intersects(const BoundingBox &other) const
+    {
+        return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+    }
+
+    inline double BoundingBox::get_squared_distance(double x, double y) const
+    {
+        double dx = std::max({min_x - x, 0.0, x - max_x});
+        double dy = std::max({min_y - y, 0.0, y - max_y});
+        return dx * dx + dy * dy;
+    }
+
+    namespace detail
+    {
+        inline PackedRTree::PackedRTree(const std::vector<BoundingBox> &items) : num_items(items.size())
+        {
+            if (items.empty())
+                return;
+
+            // Sort the items by the Hilbert value of their centers on a 2^16 x 2^16 grid over the extent
+            BoundingBox extent = items[0];
+            for (const auto &item : items)
+            {
+                extent.min_x = std::min(extent.min_x, item.min_x);
+                extent.min_y = std::min(extent.min_y, item.min_y);
+                extent.max_x = std::max(extent.max_x, item.max_x);
+                extent.max_y = std::max(extent.max_y, item.max_y);
+            }
+            const double width = extent.max_x - extent.min_x;
+            const double height = extent.max_y - extent.min_y;
+            const double scale = 65535.0;
+            std::vector<std::uint64_t> hilbert_values(items.size());
+            for (std::size_t i = 0; i < items.size(); i++)
+            {
+                double center_x = (items[i].min_x + items[i].max_x) / 2;
+                double center_y = (items[i].min_y + items[i].max_y) / 2;
+                auto grid_x = std::uint32_t(width > 0 ? scale * (center_x - extent.min_x) / width : 0);
+                auto grid_y = std::uint32_t(height > 0 ? scale * (center_y - extent.min_y) / height : 0);
+                hilbert_values[i] = get_hilbert_value(grid_x, grid_y);
+            }
+            indices.resize(items.size());
+            std::iota(indices.begin(), indices.end(), std::size_t(0));
+            std::sort(indices.begin(), indices.end(), [&](std::size_t a, std::size_t b)
+                      { return hilbert_values[a] != hilbert_values[b] ? hilbert_values[a] < hilbert_values[b] : a < b; });
+
+            boxes.reserve(items.size() + items.size() / (NODE_SIZE - 1) + 1);
+            for (auto item : indices)
+                boxes.push_back(items[item]);
+
+            // Every run of NODE_SIZE consecutive entries of a level gets a parent, up to a single root
+            level_ends.push_back(num_items);
+            std::size_t level_begin = 0;
+            while (level_ends.back() - level_begin > 1)
+            {
+                const std::size_t level_end = level_ends.back();
+                for (std::size_t first = level_begin; first < level_end; first += NODE_SIZE)
+                {
+                    BoundingBox node = boxes[first];
+                    for (std::size_t child = first + 1; child < std::min(first + NODE_SIZE, level_end); child++)
+                    {
+                        node.min_x = std::min(node.min_x, boxes[child].min_x);
+                        node.min_y = std::min(node.min_y, boxes[child].min_y);
+                        node.max_x = std::max(node.max_x, boxes[child].max_x);
+                        node.max_y = std::max(node.max_y, boxes[child].max_y);
+                    }
+                    boxes.push_back(node);
+                    indices.push_back(first);
+                }
+                level_begin = level_end;
+                level_ends.push_back(boxes.size());
+            }
+        }
+
+        inline bool PackedRTree::is_empty() const
+        {
+            return num_items == 0;
+        }
+
+        inline std::uint64_t PackedRTree::get_hilbert_value(std::uint32_t x, std::uint32_t y)
+        {
+            std::uint64_t value = 0;
+            for (std::uint32_t s = 1u << 15; s > 0; s /= 2)
+            {
+                std::uint32_t rx = (x & s) > 0;
+                std::uint32_t ry = (y & s) > 0;
+                value += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+                // Rotate the quadrant so the curve stays continuous
+                if (ry == 0)
+                {
+                    if (rx == 1)
+                    {
+                        x = s - 1 - (x & (s - 1));
+                        y = s - 1 - (y & (s - 1));
+                    }
+                    std::swap(x, y);
+                }
+                x &= s - 1;
+                y &= s - 1;
+            }
+            return value;
+        }
+
+        inline std::size_t PackedRTree::get_children_end(std::size_t node, std::size_t level) const
+        {
+            return std::min(indices[node] + NODE_SIZE, level_ends[level - 1]);
+        }
+
+        template <class Visit>
+        inline void PackedRTree::search(const BoundingBox &box, Visit visit) const
+        {
+            if (is_empty() || !boxes.back().intersects(box))
+                return;
+            std::vector<std::pair<std::size_t, std::size_t>> stack; // (entry, level)
+            stack.emplace_back(boxes.size() - 1, level_ends.size() - 1);
+            while (!stack.empty())
+            {
+                auto [node, level] = stack.back();
+                stack.pop_back();
+                if (level == 0)
+                {
+                    visit(indices[node]);
+                    continue;
+                }
+                for (std::size_t child = indices[node]; child < get_children_end(node, level); child++)
+                {
+                    if (boxes[child].intersects(box))
+                        stack.emplace_back(child, level - 1);
+                }
+            }
+        }
+
+        template <class Distance, class Visit>
+        inline void PackedRTree::nearest(double x, double y, Distance distance, Visit visit) const
+        {
+            if (is_empty())
+                return;
+
+            // Best-first search. Nodes are ordered by the distance to their box, which bounds every
+            // item below them, and come before items at the same distance, so an item is only visited
+            // once nothing unexplored can be closer or tie with a lower index.
+            struct Entry
+            {
+                double distance;
+                bool is_item;
+                std::size_t id; // Input index of an item, entry of a node
+                std::size_t level;
+
+                bool operator>(const Entry &other) const
+                {
+                    if (distance != other.distance)
+                        return distance > other.distance;
+                    if (is_item != other.is_item)
+                        return is_item;
+                    return id > other.id;
+                }
+            };
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+            auto push = [&](std::size_t entry, std::size_t level)
+            {
+                if (level == 0)
+                    queue.push({distance(indices[entry]), true, indices[entry], 0});
+                else
+                    queue.push({boxes[entry].get_squared_distance(x, y), false, entry, level});
+            };
+
+            push(boxes.size() - 1, level_ends.size() - 1);
+            while (!queue.empty())
+            {
+                Entry top = queue.top();
+                queue.pop();
+                if (top.is_item)
+                {
+                    if (!visit(top.id, top.distance))
+                        return;
+                    continue;
+                }
+                for (std::size_t child = indices[top.id]; child < get_children_end(top.id, top.level); child++)
+                    push(child, top.level - 1);
+            }
+        }
+    } // namespace detail
+
+    template <class T>
+    inline SpatialIndex<T>::SpatialIndex(const CSRGraph<T> &csr) : csr(csr)
+    {
+        const std::size_t num_vertices = csr.get_num_vertices();
+        std::vector<BoundingBox> items;
+        items.reserve(num_vertices);
+        for (Index index = 0; index < num_vertices; index++)
+        {
+            double x = csr.get_x(index);
+            double y = csr.get_y(index);
+            items.push_back({x, y, x, y});
+        }
+        vertex_tree = detail::PackedRTree(items);
+
+        items.clear();
+        items.reserve(csr.get_num_edges());
+        edge_sources.reserve(csr.get_num_edges());
+        for (Index index = 0; index < num_vertices; index++)
+        {
+            for (auto edge = csr.edges_begin(index); edge != csr.edges_end(index); edge++)
+            {
+                Index target_index = csr.get_target(edge);
+                double x1 = csr.get_x(index), y1 = csr.get_y(index);
+                double x2 = csr.get_x(target_index), y2 = csr.get_y(target_index);
+                items.push_back({std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)});
+                edge_sources.push_back(index);
+            }
+        }
+        edge_tree = detail::PackedRTree(items);
+    }
+
+    template <class T>
+    inline double SpatialIndex<T>::get_squared_distance(Index index, double x, double y) const
+    {
+        double dx = csr.get_x(index) - x;
+        double dy = csr.get_y(index) - y;
+        return dx * dx + dy * dy;
+    }
+
+    template <class T>
+    inline typename SpatialIndex<T>::EdgeSnap SpatialIndex<T>::project(EdgeIndex edge, double x, double y) const
+    {
+        EdgeSnap snap;
+        snap.edge = edge;
+        snap.source_index = edge_sources[edge];
+        snap.target_index = csr.get_target(edge);
+        double x1 = csr.get_x(snap.source_index), y1 = csr.get_y(snap.source_index);
+        double dx = csr.get_x(snap.target_index) - x1;
+        double dy = csr.get_y(snap.target_index) - y1;
+        double length = dx * dx + dy * dy;
+        snap.fraction = length > 0 ? std::clamp(((x - x1) * dx + (y - y1) * dy) / length, 0.0, 1.0) : 0.0;
+        snap.x = x1 + snap.fraction * dx;
+        snap.y = y1 + snap.fraction * dy;
+        snap.distance = (snap.x - x) * (snap.x - x) + (snap.y - y) * (snap.y - y);
+        return snap;
+    }
+
+    template <class T>
+    inline typename SpatialIndex<T>::Index SpatialIndex<T>::nearest_vertex(double x, double y) const
+    {
+        Index nearest = CSRGraph<T>::INVALID_INDEX;
+        vertex_tree.nearest(x, y, [&](std::size_t index)
+                            { return get_squared_distance(Index(index), x, y); }, [&](std::size_t index, double)
+                            { nearest = Index(index); return false; });
+        return nearest;
+    }
+
+    template <class T>
+    inline std::vector<typename SpatialIndex<T>::Index> SpatialIndex<T>::nearest_vertices(double x, double y, std::size_t k) const
+    {
+        std::vector<Index> nearest;
+        if (k == 0)
+            return nearest;
+        vertex_tree.nearest(x, y, [&](std::size_t index)
+                            { return get_squared_distance(Index(index), x, y); }, [&](std::size_t index, double)
+                            { nearest.push_back(Index(index)); return nearest.size() < k; });
+        return nearest;
+    }
+
+    template <class T>
+    inline typename SpatialIndex<T>::EdgeSnap SpatialIndex<T>::nearest_edge(double x, double y) const
+    {
+        EdgeSnap nearest;
+        edge_tree.nearest(x, y, [&](std::size_t edge)
+                          { return project(edge, x, y).distance; }, [&](std::size_t edge, double)
+                          { nearest = project(edge, x, y); return false; });
+        nearest.distance = std::sqrt(nearest.distance);
+        return nearest;
+    }
+
+    template <class T>
+    inline std::vector<typename SpatialIndex<T>::Index> SpatialIndex<T>::vertices_in_box(const BoundingBox &box) const
+    {
+        std::vector<Index> found;
+        vertex_tree.search(box, [&](std::size_t index)
+                           { found.push_back(Index(index)); });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+
+    template <class T>
+    inline std::vector<typename SpatialIndex<T>::EdgeIndex> SpatialIndex<T>::edges_in_box(const BoundingBox &box) const
+    {
+        std::vector<EdgeIndex> found;
+        edge_tree.search(box, [&](std::size_t edge)
+                         { found.push_back(edge); });
+        std::sort(found.begin(), found.end());
+        return found;
+    }
+} // namespace graph
+
+#endif // SPATIAL_INDEX_H
@@ -33,7 +33,7 @@ namespace graph
         Point get_coordinates() const;
         ValueType get_x() const;
         ValueType get_y() const;
-        Edges get_edges() const;
+        const Edges &get_edges() const;
 
         // Setters and modifiers
         void set_edges(const Edges &edges);
@@ -45,6 +45,8 @@ namespace graph
         bool is_connected_to_edge(const EdgePtr edge);
         std::size_t get_num_edges() const;
         std::vector<Vertex<T> *> get_neighboring_vertices() const;
+        template <class Visit>
+        void for_each_neighbor(Visit visit) const;
         ValueType get_min_edge_cost() const;
         ValueType get_max_edge_cost();
         std::string to_string() const;
@@ -110,7 +112,7 @@ namespace graph
     }
 
     template <class T>
-    inline typename Vertex<T>::Edges Vertex<T>::get_edges() const
+    inline const typename Vertex<T>::Edges &Vertex<T>::get_edges() const
     {
         return edges;
     }
@@ -156,20 +158,21 @@ namespace graph
     inline std::vector<Vertex<T> *> Vertex<T>::get_neighboring_vertices() const
     {
         std::vector<Vertex<T> *> neighbors;
-        for (const auto &edge : edges)
-        {
-            if (edge->get_source() == this)
-            {
-                neighbors.push_back(edge->get_destination());
-            }
-            else
-            {
-                neighbors.push_back(edge->get_source());
-            }
-        }
+        neighbors.reserve(edges.size());
+        for_each_neighbor([&](Vertex<T> *neighbor, EdgePtr)
+                          { neighbors.push_back(neighbor); });
         return neighbors;
     }
 
+    // Call visit(neighbor, edge) for every edge of the vertex, without building a container
+    template <class T>
+    template <class Visit>
+    inline void Vertex<T>::for_each_neighbor(Visit visit) const
+    {
+        for (EdgePtr edge : edges)
+            visit(edge->get_source() == this ? edge->get_destination() : edge->get_source(), edge);
+    }
+
     template <class T>
     inline typename Vertex<T>::ValueType Vertex<T>::get_min_edge_cost() const
     {
@@ -5,6 +5,7 @@
 #include <getopt.h>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 
 namespace interface
 {
@@ -19,15 +20,41 @@ namespace interface
         std::string get_input_file() const;
         std::string get_output_file() const;
         bool get_path_only() const;
+        std::string get_heuristic() const;
+        std::string get_landmark_file() const;
+        unsigned int get_num_landmarks() const;
+        std::string get_batch_file() const;
+        std::string get_matrix_file() const;
+        unsigned int get_num_threads() const;
+        double get_bucket_width() const;
+        bool get_print_stats() const;
+        bool has_start_point() const;
+        bool has_end_point() const;
+        std::tuple<double, double> get_start_point() const;
+        std::tuple<double, double> get_end_point() const;
 
     private:
         std::string algorithm;
         std::string input_file;
         std::string output_file;
-        bool path_only;
+        bool path_only = false;
+        std::string heuristic = "euclidean";
+        std::string landmark_file;
+        unsigned int num_landmarks = 16;
+        std::string batch_file;
+        std::string matrix_file;
+        unsigned int num_threads = 0;
+        double bucket_width = 0;
+        bool print_stats = false;
+        bool start_point_given = false;
+        bool end_point_given = false;
+        std::tuple<double, double> start_point;
+        std::tuple<double, double> end_point;
 
         // Helper function to display program usage help
         void display_help();
+        // Parse an "x,y" coordinate pair
+        static std::tuple<double, double> parse_point(const std::string &text);
     };
 
     // Implementation of the constructor
@@ -45,7 +72,7 @@ namespace interface
         int option;
 
         // Process command-line options using getopt
-        while ((option = getopt(argc, argv, "a:f:o:p")) != -1)
+        while ((option = getopt(argc, argv, "a:f:o:pH:L:k:b:m:t:d:sS:E:")) != -1)
         {
             switch (option)
             {
@@ -63,6 +90,63 @@ namespace interface
             case 'p':
                 path_only = true;
                 break;
+            case 's':
+                print_stats = true;
+                break;
+            case 'H':
+                heuristic = optarg;
+                break;
+            case 'L':
+                landmark_file = optarg;
+                break;
+            case 'k':
+                try
+                {
+                    num_landmarks = std::stoul(optarg);
+                }
+                catch (const std::exception &)
+                {
+                    throw std::invalid_argument("Invalid landmark count: " + std::string(optarg));
+                }
+                if (num_landmarks == 0)
+                    throw std::invalid_argument("The landmark count must be positive.");
+                break;
+            case 'b':
+                batch_file = optarg;
+                break;
+            case 'm':
+                matrix_file = optarg;
+                break;
+            case 't':
+                try
+                {
+                    num_threads = std::stoul(optarg);
+                }
+                catch (const std::exception &)
+                {
+                    throw std::invalid_argument("Invalid thread count: " + std::string(optarg));
+                }
+                break;
+            case 'd':
+                try
+                {
+                    bucket_width = std::stod(optarg);
+                }
+                catch (const std::exception &)
+                {
+                    throw std::invalid_argument("Invalid bucket width: " + std::string(optarg));
+                }
+                if (!(bucket_width > 0))
+                    throw std::invalid_argument("The bucket width must be positive.");
+                break;
+            case 'S':
+                start_point = parse_point(optarg);
+                start_point_given = true;
+                break;
+            case 'E':
+                end_point = parse_point(optarg);
+                end_point_given = true;
+                break;
             default:
                 throw std::invalid_argument("Invalid command line argument");
             }
@@ -73,9 +157,50 @@ namespace interface
         {
             throw std::invalid_argument("Both '-a' and '-f' must be provided.");
         }
-        if (algorithm != "astar" && algorithm != "dijkstra" && algorithm != "all")
+        if (algorithm != "astar" && algorithm != "dijkstra" && algorithm != "biastar" && algorithm != "bidijkstra" && algorithm != "ch" && algorithm != "deltastep" &&
+            algorithm != "all")
+        {
+            throw std::invalid_argument("Invalid algorithm option. Use 'astar', 'dijkstra', 'biastar', 'bidijkstra', 'ch', 'deltastep' or 'all'.");
+        }
+        if (heuristic != "euclidean" && heuristic != "alt")
+        {
+            throw std::invalid_argument("Invalid heuristic option. Use 'euclidean' or 'alt'.");
+        }
+        if (!batch_file.empty() && algorithm == "all")
+        {
+            throw std::invalid_argument("Batch mode runs a single algorithm, 'all' is not supported.");
+        }
+        if (!batch_file.empty() && algorithm == "deltastep")
+        {
+            throw std::invalid_argument("Batch mode runs point-to-point searches, 'deltastep' is not supported.");
+        }
+        if (!batch_file.empty() && print_stats)
+        {
+            throw std::invalid_argument("Search statistics are printed for single queries, '-s' is not supported in batch mode.");
+        }
+        if (!batch_file.empty() && (start_point_given || end_point_given))
+        {
+            throw std::invalid_argument("'-S' and '-E' set the endpoints of a single query, use coordinate lines in the query file in batch mode.");
+        }
+        if (!batch_file.empty() && output_file.empty())
+        {
+            throw std::invalid_argument("Batch mode requires '-o' for the results.");
+        }
+        if (!matrix_file.empty() && !batch_file.empty())
         {
-            throw std::invalid_argument("Invalid algorithm option. Use 'a_star', 'dijkstra' or 'all'.");
+            throw std::invalid_argument("'-b' and '-m' cannot be combined.");
+        }
+        if (!matrix_file.empty() && algorithm != "dijkstra" && algorithm != "ch")
+        {
+            throw std::invalid_argument("Matrix mode supports 'dijkstra' and 'ch'.");
+        }
+        if (!matrix_file.empty() && (print_stats || start_point_given || end_point_given))
+        {
+            throw std::invalid_argument("'-s', '-S' and '-E' apply to single queries, they are not supported in matrix mode.");
+        }
+        if (!matrix_file.empty() && output_file.empty())
+        {
+            throw std::invalid_argument("Matrix mode requires '-o' for the matrix.");
         }
     }
 
@@ -100,15 +225,105 @@ namespace interface
         return path_only;
     }
 
+    inline std::string CLIInterface::get_heuristic() const
+    {
+        return heuristic;
+    }
+
+    inline std::string CLIInterface::get_landmark_file() const
+    {
+        return landmark_file;
+    }
+
+    inline unsigned int CLIInterface::get_num_landmarks() const
+    {
+        return num_landmarks;
+    }
+
+    inline std::string CLIInterface::get_batch_file() const
+    {
+        return batch_file;
+    }
+
+    inline std::string CLIInterface::get_matrix_file() const
+    {
+        return matrix_file;
+    }
+
+    inline unsigned int CLIInterface::get_num_threads() const
+    {
+        return num_threads;
+    }
+
+    inline double CLIInterface::get_bucket_width() const
+    {
+        return bucket_width;
+    }
+
+    inline bool CLIInterface::get_print_stats() const
+    {
+        return print_stats;
+    }
+
+    inline bool CLIInterface::has_start_point() const
+    {
+        return start_point_given;
+    }
+
+    inline bool CLIInterface::has_end_point() const
+    {
+        return end_point_given;
+    }
+
+    inline std::tuple<double, double> CLIInterface::get_start_point() const
+    {
+        return start_point;
+    }
+
+    inline std::tuple<double, double> CLIInterface::get_end_point() const
+    {
+        return end_point;
+    }
+
+    inline std::tuple<double, double> CLIInterface::parse_point(const std::string &text)
+    {
+        auto comma = text.find(',');
+        try
+        {
+            if (comma != std::string::npos)
+            {
+                std::size_t x_length, y_length;
+                double x = std::stod(text.substr(0, comma), &x_length);
+                double y = std::stod(text.substr(comma + 1), &y_length);
+                if (x_length == comma && y_length == text.size() - comma - 1)
+                    return std::make_tuple(x, y);
+            }
+        }
+        catch (const std::exception &)
+        {
+        }
+        throw std::invalid_argument("Invalid coordinates: " + text + ". Use 'x,y'.");
+    }
+
     // Helper function to display usage help
     void CLIInterface::display_help()
     {
         std::cout << "Usage: program <input_file> [options]" << std::endl;
         std::cout << "Options:" << std::endl;
-        std::cout << "  -a <algorithm>      Specify the algorithm (astar or dijkstra). Use 'all' for both." << std::endl;
+        std::cout << "  -a <algorithm>      Specify the algorithm (astar, dijkstra, biastar, bidijkstra, ch or deltastep). Use 'all' for astar and dijkstra." << std::endl;
         std::cout << "  -f <output_file>    Read input path to a text file." << std::endl;
         std::cout << "  -o <output_file>    Save output path to a text file." << std::endl;
         std::cout << "  -p                  Output path only (no additional information)." << std::endl;
+        std::cout << "  -s                  Print the search statistics of the astar and dijkstra queries as JSON." << std::endl;
+        std::cout << "  -H <heuristic>      A* heuristic (euclidean or alt). Default: euclidean." << std::endl;
+        std::cout << "  -L <landmark_file>  Load ALT landmarks from the file, or compute and save them if it does not exist." << std::endl;
+        std::cout << "  -k <count>          Number of ALT landmarks to compute. Default: 16." << std::endl;
+        std::cout << "  -b <query_file>     Batch mode: solve every 'start end' pair (or 'x1 y1 x2 y2' coordinates) of the file and write the results to -o." << std::endl;
+        std::cout << "  -m <query_file>     Matrix mode: costs from every start to every end vertex of the query file (dijkstra or ch), written to -o." << std::endl;
+        std::cout << "  -t <threads>        Worker threads for loading, batch and matrix mode and deltastep. Default: all cores." << std::endl;
+        std::cout << "  -d <width>          Bucket width for deltastep. Default: mean edge cost." << std::endl;
+        std::cout << "  -S <x,y>            Start at the vertex nearest to these coordinates instead of the file's start vertex." << std::endl;
+        std::cout << "  -E <x,y>            End at the vertex nearest to these coordinates instead of the file's end vertex." << std::endl;
     }
 
 } // namespace interface
@@ -32,7 +32,7 @@ namespace interface
     {
     public:
         GraphDisplay(QWidget *parent = nullptr);
-        void set_graph(const Graph<T> &graph_);
+        void set_graph(Graph<T> graph_);
         void set_scale_factor(double sf);
         void set_view();
         void create_legend();
@@ -53,7 +53,7 @@ namespace interface
         std::unordered_map<unsigned int, ClickableVertexItem *> circles;
         void draw_vertex(Vertex<T> *vertex, Qt::GlobalColor color = Qt::black);
         void draw_edge(Edge<T> *edge, Qt::GlobalColor color = Qt::black, int thickness = 1, double arrow_size = 8);
-        void draw_path(std::vector<unsigned int> path, Qt::GlobalColor edge_color = Qt::darkGreen);
+        void draw_path(const std::vector<unsigned int> &path, Qt::GlobalColor edge_color = Qt::darkGreen);
         void show_edge_info(const QPointF &pos, const QString &info);
     };
 
@@ -70,9 +70,9 @@ namespace interface
     }
 
     template <class T>
-    inline void GraphDisplay<T>::set_graph(const Graph<T> &graph_)
+    inline void GraphDisplay<T>::set_graph(Graph<T> graph_)
     {
-        graph = graph_;
+        graph = std::move(graph_);
     }
 
     template <class T>
@@ -123,8 +123,8 @@ namespace interface
         for (auto &vertex : graph.get_vertices())
             draw_vertex(vertex.second);
 
-        auto astar_path = graph.get_astar_path();
-        auto dijkstra_path = graph.get_dijkstra_path();
+        const auto &astar_path = graph.get_astar_path();
+        const auto &dijkstra_path = graph.get_dijkstra_path();
 
         // Draw path for astar if exists
         if (!astar_path.empty())
@@ -219,7 +219,7 @@ namespace interface
     }
 
     template <class T>
-    inline void GraphDisplay<T>::draw_path(std::vector<unsigned int> path, Qt::GlobalColor edge_color)
+    inline void GraphDisplay<T>::draw_path(const std::vector<unsigned int> &path, Qt::GlobalColor edge_color)
     {
         // Draw all the edges
         auto edges = graph.get_path_edges(path);
@@ -13,7 +13,7 @@ namespace interface
     public:
         // Constructor for the main window
         explicit MainWindow(QWidget *parent = nullptr);
-        void set_graph(const graph::Graph<T> &graph);
+        void set_graph(graph::Graph<T> graph);
         void draw_graph(unsigned int scale_factor, bool path_only = true);
 
     private:
@@ -29,10 +29,10 @@ namespace interface
     }
 
     template <class T>
-    void MainWindow<T>::set_graph(const graph::Graph<T> &graph)
+    void MainWindow<T>::set_graph(graph::Graph<T> graph)
     {
-        // Set the graph to be displayed in the widget
-        display->set_graph(graph);
+        // Hand the graph over to the widget that displays it
+        display->set_graph(std::move(graph));
     }
 
     template <class T>
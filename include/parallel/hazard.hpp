@@ -0,0 +1,242 @@
+#ifndef HAZARD_H
+#define HAZARD_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+namespace parallel
+{
+    // Hazard pointers for objects published through an atomic pointer. A reader protects the current
+    // object by announcing it in a slot of its own, with no lock and no write to shared counters; a
+    // writer that replaced the object retires the old one, and it is deleted once no slot announces it.
+    // Both retire() and releasing the last guard of a retired object reclaim, so an object is freed when
+    // its last reader lets go, not when the next writer comes along. Releases only take the reclaim lock
+    // while retired objects are waiting, so readers stay lock-free while nothing is being replaced.
+    // Slots live in blocks that are added as readers need them and kept until the domain goes away.
+    template <class V>
+    class HazardDomain
+    {
+    private:
+        struct Slot
+        {
+            std::atomic<const V *> hazard{nullptr};
+            std::atomic<bool> in_use{false};
+        };
+
+    public:
+        // Keeps one object alive until it is destroyed or released
+        class Guard
+        {
+        public:
+            Guard();
+            Guard(Guard &&other) noexcept;
+            Guard &operator=(Guard &&other) noexcept;
+            ~Guard();
+
+            const V *get() const;
+            void release();
+
+        private:
+            friend class HazardDomain;
+            Guard(HazardDomain *domain, Slot *slot, const V *object);
+
+            HazardDomain *domain;
+            Slot *slot;
+            const V *object;
+        };
+
+        HazardDomain() = default;
+        ~HazardDomain();
+
+        HazardDomain(const HazardDomain &) = delete;
+        HazardDomain &operator=(const HazardDomain &) = delete;
+
+        // Protect whatever source points to when the call returns
+        Guard protect(const std::atomic<V *> &source);
+
+        // Hand over an object that is no longer reachable through the source. It is deleted right away
+        // when no guard holds it, otherwise when the last guard holding it is released.
+        void retire(V *object);
+
+        // Number of retired objects still held by a guard
+        std::size_t get_num_retired() const;
+
+    private:
+        static constexpr std::size_t SLOTS_PER_BLOCK = 64;
+
+        struct Block
+        {
+            Slot slots[SLOTS_PER_BLOCK];
+            Block *next = nullptr;
+        };
+
+        std::atomic<Block *> blocks{nullptr};
+        std::mutex retired_mutex;
+        std::vector<V *> retired; // Guarded by retired_mutex
+        std::atomic<std::size_t> num_retired{0};
+
+        Slot *acquire_slot();
+        // Delete the retired objects no slot announces, the caller holds retired_mutex
+        void reclaim();
+        void reclaim_after_release();
+    };
+
+    template <class V>
+    inline HazardDomain<V>::Guard::Guard() : domain(nullptr), slot(nullptr), object(nullptr) {}
+
+    template <class V>
+    inline HazardDomain<V>::Guard::Guard(HazardDomain *domain, Slot *slot, const V *object) : domain(domain), slot(slot), object(object) {}
+
+    template <class V>
+    inline HazardDomain<V>::Guard::Guard(Guard &&other) noexcept
+        : domain(std::exchange(other.domain, nullptr)), slot(std::exchange(other.slot, nullptr)), object(std::exchange(other.object, nullptr)) {}
+
+    template <class V>
+    inline typename HazardDomain<V>::Guard &HazardDomain<V>::Guard::operator=(Guard &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            domain = std::exchange(other.domain, nullptr);
+            slot = std::exchange(other.slot, nullptr);
+            object = std::exchange(other.object, nullptr);
+        }
+        return *this;
+    }
+
+    template <class V>
+    inline HazardDomain<V>::Guard::~Guard()
+    {
+        release();
+    }
+
+    template <class V>
+    inline const V *HazardDomain<V>::Guard::get() const
+    {
+        return object;
+    }
+
+    template <class V>
+    inline void HazardDomain<V>::Guard::release()
+    {
+        if (slot)
+        {
+            slot->hazard.store(nullptr);
+            slot->in_use.store(false, std::memory_order_release);
+            slot = nullptr;
+            object = nullptr;
+            std::exchange(domain, nullptr)->reclaim_after_release();
+        }
+    }
+
+    template <class V>
+    inline HazardDomain<V>::~HazardDomain()
+    {
+        // Every guard must be gone by now
+        for (auto object : retired)
+            delete object;
+        Block *block = blocks.load();
+        while (block)
+        {
+            Block *next = block->next;
+            delete block;
+            block = next;
+        }
+    }
+
+    template <class V>
+    inline typename HazardDomain<V>::Guard HazardDomain<V>::protect(const std::atomic<V *> &source)
+    {
+        Slot *slot = acquire_slot();
+        const V *object = source.load();
+        while (true)
+        {
+            // The announcement only counts if the source still points to the object afterwards,
+            // otherwise a writer may have scanned the slots before it became visible
+            slot->hazard.store(object);
+            const V *current = source.load();
+            if (current == object)
+                break;
+            object = current;
+        }
+        return Guard(this, slot, object);
+    }
+
+    template <class V>
+    inline void HazardDomain<V>::retire(V *object)
+    {
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        retired.push_back(object);
+        // Published before the scan: a reader that clears its hazard after the scan sees the count
+        num_retired.store(retired.size());
+        reclaim();
+    }
+
+    template <class V>
+    inline std::size_t HazardDomain<V>::get_num_retired() const
+    {
+        return num_retired.load();
+    }
+
+    template <class V>
+    inline void HazardDomain<V>::reclaim_after_release()
+    {
+        // The hazard was cleared before the check. Seeing no retired object means that any retire()
+        // still to scan will find the slot cleared.
+        if (num_retired.load() == 0)
+            return;
+        std::lock_guard<std::mutex> lock(retired_mutex);
+        reclaim();
+    }
+
+    template <class V>
+    inline typename HazardDomain<V>::Slot *HazardDomain<V>::acquire_slot()
+    {
+        for (Block *block = blocks.load(std::memory_order_acquire); block; block = block->next)
+        {
+            for (auto &slot : block->slots)
+            {
+                bool expected = false;
+                if (!slot.in_use.load(std::memory_order_relaxed) && slot.in_use.compare_exchange_strong(expected, true))
+                    return &slot;
+            }
+        }
+
+        // Every slot is taken, add a block with the first slot already claimed
+        Block *block = new Block();
+        block->slots[0].in_use.store(true, std::memory_order_relaxed);
+        Block *head = blocks.load(std::memory_order_relaxed);
+        do
+            block->next = head;
+        while (!blocks.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+        return &block->slots[0];
+    }
+
+    template <class V>
+    inline void HazardDomain<V>::reclaim()
+    {
+        std::vector<const V *> hazards;
+        for (Block *block = blocks.load(std::memory_order_acquire); block; block = block->next)
+        {
+            for (auto &slot : block->slots)
+            {
+                if (const V *hazard = slot.hazard.load())
+                    hazards.push_back(hazard);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end(), std::less<const V *>());
+
+        auto kept = std::partition(retired.begin(), retired.end(), [&](V *object)
+                                   { return std::binary_search(hazards.begin(), hazards.end(), static_cast<const V *>(object), std::less<const V *>()); });
+        for (auto it = kept; it != retired.end(); it++)
+            delete *it;
+        retired.erase(kept, retired.end());
+        num_retired.store(retired.size());
+    }
+} // namespace parallel
+
+#endif // HAZARD_H
@@ -0,0 +1,146 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+namespace parallel
+{
+    // Fixed-size pool of worker threads consuming a FIFO task queue
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(unsigned int num_threads = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        unsigned int get_num_threads() const;
+
+        // Queue a task, tasks must not throw
+        void submit(std::function<void()> task);
+
+        // Block until every submitted task has finished
+        void wait();
+
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable task_available;
+        std::condition_variable tasks_done;
+        std::size_t active_tasks = 0;
+        bool stopping = false;
+
+        void work();
+    };
+
+    inline ThreadPool::ThreadPool(unsigned int num_threads)
+    {
+        if (num_threads == 0)
+            num_threads = 1; // hardware_concurrency may be unknown
+        workers.reserve(num_threads);
+        for (unsigned int i = 0; i < num_threads; i++)
+            workers.emplace_back(&ThreadPool::work, this);
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        task_available.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    inline unsigned int ThreadPool::get_num_threads() const
+    {
+        return workers.size();
+    }
+
+    inline void ThreadPool::submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push(std::move(task));
+        }
+        task_available.notify_one();
+    }
+
+    inline void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        tasks_done.wait(lock, [this]()
+                        { return tasks.empty() && active_tasks == 0; });
+    }
+
+    inline void ThreadPool::work()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                task_available.wait(lock, [this]()
+                                    { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return; // Stopping and nothing left to run
+                task = std::move(tasks.front());
+                tasks.pop();
+                active_tasks++;
+            }
+            task();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                active_tasks--;
+                if (tasks.empty() && active_tasks == 0)
+                    tasks_done.notify_all();
+            }
+        }
+    }
+
+    // Run body(state, i) for every i in [0, count) on the pool's threads and block until done. Every
+    // worker calls make_state() once, so per-worker scratch space (search workspaces) is not shared.
+    // Indices are claimed one at a time, the first exception thrown by a worker is rethrown here.
+    template <class StateFactory, class Body>
+    void for_each_index(ThreadPool &pool, std::size_t count, StateFactory make_state, Body body)
+    {
+        std::atomic<std::size_t> next_index(0);
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        const unsigned int num_workers = std::min<std::size_t>(pool.get_num_threads(), count);
+        for (unsigned int worker = 0; worker < num_workers; worker++)
+        {
+            pool.submit([&]()
+                        {
+                try
+                {
+                    auto state = make_state();
+                    for (std::size_t i = next_index++; i < count; i = next_index++)
+                        body(state, i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    next_index = count; // Let the other workers stop early
+                } });
+        }
+        pool.wait();
+        if (error)
+            std::rethrow_exception(error);
+    }
+} // namespace parallel
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,84 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace parser
+{
+    // Read-only view of a whole file. The file is memory-mapped when possible and read into a
+    // buffer otherwise (pipes, file systems without mmap support). Sequential mappings are read
+    // ahead aggressively, others are paged in on access.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string &filename, bool sequential = true);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data() const;
+        std::size_t size() const;
+
+    private:
+        void *mapping = MAP_FAILED;
+        std::size_t length = 0;
+        std::vector<char> buffer;
+    };
+
+    inline MappedFile::MappedFile(const std::string &filename, bool sequential)
+    {
+        int descriptor = ::open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0)
+        {
+            throw std::runtime_error("Error opening file: " + filename);
+        }
+        struct stat status;
+        if (::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0)
+        {
+            length = status.st_size;
+            mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping != MAP_FAILED && sequential)
+                ::madvise(mapping, length, MADV_SEQUENTIAL);
+        }
+        if (mapping == MAP_FAILED)
+        {
+            // Fall back to reading the file in blocks
+            length = 0;
+            char block[1 << 16];
+            ssize_t count;
+            while ((count = ::read(descriptor, block, sizeof(block))) > 0)
+                buffer.insert(buffer.end(), block, block + count);
+            if (count < 0)
+            {
+                ::close(descriptor);
+                throw std::runtime_error("Error reading file: " + filename);
+            }
+        }
+        ::close(descriptor);
+    }
+
+    inline MappedFile::~MappedFile()
+    {
+        if (mapping != MAP_FAILED)
+            ::munmap(mapping, length);
+    }
+
+    inline const char *MappedFile::data() const
+    {
+        return mapping != MAP_FAILED ? static_cast<const char *>(mapping) : buffer.data();
+    }
+
+    inline std::size_t MappedFile::size() const
+    {
+        return mapping != MAP_FAILED ? length : buffer.size();
+    }
+} // namespace parser
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,138 @@
+#ifndef QUERY_READER_H
+#define QUERY_READER_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <tuple>
+#include <stdexcept>
+#include <charconv>
+#include <system_error>
+#include "mapped_file.hpp"
+
+namespace parser
+{
+    // Reads a batch query file: one "start end" pair of vertex positions per line, or "x1 y1 x2 y2"
+    // coordinates to be snapped to the nearest vertices. Blank lines and lines starting with '#' are skipped.
+    // The file is memory-mapped and every field is parsed in place with std::from_chars.
+    class QueryFileReader
+    {
+    public:
+        using QueryInfo = std::tuple<unsigned int, unsigned int>;
+        using PointQueryInfo = std::tuple<double, double, double, double>;
+
+        QueryFileReader(const std::string &filename);
+
+        const std::vector<QueryInfo> &get_queries() const;
+        bool has_point_queries() const;
+
+        // Replace the coordinates of every coordinate query by snap(x, y) -> vertex position
+        template <class Snap>
+        void resolve_points(Snap snap);
+
+    private:
+        std::vector<QueryInfo> queries;
+        std::vector<std::tuple<std::size_t, PointQueryInfo>> point_queries; // (query, coordinates)
+
+        // A coordinate query has the most fields
+        static constexpr std::size_t MAX_TOKENS = 4;
+
+        static bool is_blank(char c);
+        // Parse the whole token, a vertex position with a leading '-' is rejected rather than wrapped
+        template <class Value>
+        static bool parse_token(std::string_view token, Value &value);
+    };
+
+    inline QueryFileReader::QueryFileReader(const std::string &filename)
+    {
+        MappedFile file(filename);
+        const char *end = file.data() + file.size();
+        std::size_t line_number = 0;
+        for (const char *line = file.data(); line < end;)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+            const char *line_end = newline ? newline : end;
+            line_number++;
+
+            // Split the line into its fields, one more than a query holds is enough to reject it
+            std::string_view tokens[MAX_TOKENS + 1];
+            std::size_t num_tokens = 0;
+            for (const char *current = line; num_tokens <= MAX_TOKENS;)
+            {
+                while (current < line_end && is_blank(*current))
+                    current++;
+                if (current == line_end)
+                    break;
+                const char *token = current;
+                while (current < line_end && !is_blank(*current))
+                    current++;
+                tokens[num_tokens++] = std::string_view(token, current - token);
+            }
+            line = newline ? newline + 1 : end;
+            if (num_tokens == 0 || tokens[0][0] == '#')
+            {
+                continue; // Skip blank lines (CRLF included) and comments
+            }
+
+            if (num_tokens == 4)
+            {
+                double x1, y1, x2, y2;
+                if (!parse_token(tokens[0], x1) || !parse_token(tokens[1], y1) || !parse_token(tokens[2], x2) || !parse_token(tokens[3], y2))
+                {
+                    throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": expected start and end coordinates");
+                }
+                point_queries.emplace_back(queries.size(), PointQueryInfo(x1, y1, x2, y2));
+                queries.emplace_back(0, 0);
+                continue;
+            }
+
+            unsigned int start, end_position;
+            if (num_tokens != 2 || !parse_token(tokens[0], start) || !parse_token(tokens[1], end_position))
+            {
+                throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": expected a start and an end vertex");
+            }
+            queries.emplace_back(start, end_position);
+        }
+    }
+
+    inline const std::vector<QueryFileReader::QueryInfo> &QueryFileReader::get_queries() const
+    {
+        return queries;
+    }
+
+    inline bool QueryFileReader::has_point_queries() const
+    {
+        return !point_queries.empty();
+    }
+
+    inline bool QueryFileReader::is_blank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    template <class Value>
+    inline bool QueryFileReader::parse_token(std::string_view token, Value &value)
+    {
+        const char *first = token.data();
+        const char *last = first + token.size();
+        if (first < last && *first == '+')
+            first++; // Accepted by the stream parser this replaces
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+
+    template <class Snap>
+    inline void QueryFileReader::resolve_points(Snap snap)
+    {
+        for (const auto &point_query : point_queries)
+        {
+            double x1, y1, x2, y2;
+            std::tie(x1, y1, x2, y2) = std::get<1>(point_query);
+            queries[std::get<0>(point_query)] = QueryInfo(snap(x1, y1), snap(x2, y2));
+        }
+        point_queries.clear();
+    }
+} // namespace parser
+
+#endif // QUERY_READER_H
@@ -1,127 +1,257 @@
 #ifndef READER_H
 #define READER_H
 
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <tuple>
-#include <iostream>
-#include "../graph/graph.hpp"
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <exception>
+#include "../graph/graph_builder.hpp"
+#include "../parallel/thread_pool.hpp"
+#include "mapped_file.hpp"
 
 namespace parser
 {
+    // Reads a graph file: a start/end header line, the vertex section up to the first blank line
+    // after a vertex, then the edges. Lines starting with '#' and blank lines are skipped. The file is
+    // memory-mapped and parsed in one pass with std::from_chars, vertices and edges are pushed straight
+    // into a GraphBuilder without any intermediate container. Large edge sections are split at line
+    // boundaries and the chunks are parsed concurrently.
     template <class T>
     class GraphFileReader
     {
     public:
         using StartEndInfo = std::tuple<unsigned int, unsigned int>;
-        using VertexInfo = std::tuple<unsigned int, T, T>;
-        using EdgeInfo = std::tuple<unsigned int, unsigned int, double>;
 
-        GraphFileReader(const std::string &filename);
+        // num_threads bounds the edge parsing threads, 0 uses every core
+        GraphFileReader(const std::string &filename, graph::GraphBuilder<T> &builder, unsigned int num_threads = 0);
 
-        StartEndInfo get_start_end();
-        std::vector<VertexInfo> get_vertices();
-        std::vector<EdgeInfo> get_edges();
+        StartEndInfo get_start_end() const;
 
     private:
-        std::ifstream file;
+        // Smallest share of the edge section worth a thread of its own
+        static constexpr std::size_t MIN_CHUNK_SIZE = 1 << 22;
+
+        std::string filename;
+        unsigned int num_threads; // At least 1, hardware_concurrency may be unknown
         StartEndInfo start_end;
-        std::vector<VertexInfo> vertices;
-        std::vector<EdgeInfo> edges;
-        void read_start_end();
-        void read_vertices();
-        void read_edges();
+
+        void parse(const char *begin, const char *end, graph::GraphBuilder<T> &builder);
+        void parse_edge_section(const char *begin, const char *end, std::size_t line_number, graph::GraphBuilder<T> &builder);
+        template <class Emit>
+        void parse_edges(const char *begin, const char *end, std::size_t line_number, Emit emit) const;
+        template <class Value>
+        void parse_field(const char *&current, const char *line_end, Value &value, std::size_t line_number, const char *field) const;
+        void check_line_end(const char *current, const char *line_end, std::size_t line_number) const;
     };
 
     template <class T>
-    inline GraphFileReader<T>::GraphFileReader(const std::string &filename) : file(filename)
+    inline GraphFileReader<T>::GraphFileReader(const std::string &filename, graph::GraphBuilder<T> &builder, unsigned int num_threads)
+        : filename(filename), num_threads(num_threads ? num_threads : std::max(1u, std::thread::hardware_concurrency())), start_end(0, 0)
     {
-        if (!file)
-        {
-            throw std::runtime_error("Error opening file: " + filename);
-        }
-        read_start_end();
-        read_vertices();
-        read_edges();
+        MappedFile file(filename);
+        parse(file.data(), file.data() + file.size(), builder);
     }
 
     template <class T>
-    inline void GraphFileReader<T>::read_start_end()
+    inline void GraphFileReader<T>::parse(const char *begin, const char *end, graph::GraphBuilder<T> &builder)
     {
-        std::string line;
-        while (std::getline(file, line))
+        enum class Section
         {
-            if (line.empty() || line[0] == '#')
+            START_END,
+            VERTICES
+        };
+        Section section = Section::START_END;
+        std::size_t line_number = 0;
+        bool has_vertices = false;
+
+        for (const char *line = begin; line < end;)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+            const char *line_end = newline ? newline : end;
+            const char *next_line = newline ? newline + 1 : end;
+            line_number++;
+
+            // Blank lines (whitespace only, CRLF included) separate sections
+            const char *current = line;
+            while (current < line_end && (*current == ' ' || *current == '\t' || *current == '\r'))
+                current++;
+            const bool blank = current == line_end;
+
+            if (blank && has_vertices)
             {
-                continue; // Skip empty lines and comments
+                // Stop reading for vertices, every remaining line is at most one edge
+                parse_edge_section(next_line, end, line_number, builder);
+                return;
             }
-            unsigned int start, end;
-            std::stringstream ss(line);
-            ss >> start >> end;
-            start_end = std::make_tuple(start, end);
-            break;
+            else if (!blank && *current != '#')
+            {
+                if (section == Section::START_END)
+                {
+                    unsigned int start, end_position;
+                    parse_field(current, line_end, start, line_number, "start vertex");
+                    parse_field(current, line_end, end_position, line_number, "end vertex");
+                    check_line_end(current, line_end, line_number);
+                    start_end = std::make_tuple(start, end_position);
+                    section = Section::VERTICES;
+                }
+                else
+                {
+                    unsigned int vertex_id;
+                    T x, y;
+                    parse_field(current, line_end, vertex_id, line_number, "vertex position");
+                    parse_field(current, line_end, x, line_number, "x coordinate");
+                    parse_field(current, line_end, y, line_number, "y coordinate");
+                    check_line_end(current, line_end, line_number);
+                    builder.add_vertex(vertex_id, x, y);
+                    has_vertices = true;
+                }
+            }
+            line = next_line;
         }
     }
 
     template <class T>
-    inline void GraphFileReader<T>::read_vertices()
+    inline void GraphFileReader<T>::parse_edge_section(const char *begin, const char *end, std::size_t line_number, graph::GraphBuilder<T> &builder)
     {
-        std::string line;
-        while (std::getline(file, line))
+        const std::size_t num_chunks = std::clamp<std::size_t>((end - begin) / MIN_CHUNK_SIZE, 1, num_threads);
+        if (num_chunks == 1)
+        {
+            builder.reserve_edges(builder.get_num_edges() + std::count(begin, end, '\n') + 1);
+            parse_edges(begin, end, line_number, [&](unsigned int source, unsigned int target, double cost)
+                        { builder.add_edge(source, target, cost); });
+            return;
+        }
+
+        // Cut the section into chunks of whole lines
+        std::vector<const char *> bounds{begin};
+        for (std::size_t chunk = 1; chunk < num_chunks; chunk++)
+        {
+            const char *split = std::max(bounds.back(), begin + (end - begin) * chunk / num_chunks);
+            const char *newline = static_cast<const char *>(std::memchr(split, '\n', end - split));
+            bounds.push_back(newline ? newline + 1 : end);
+        }
+        bounds.push_back(end);
+
+        // Count the lines of every chunk first so that each one knows the line number it starts at.
+        // A line holds at most one edge, so the lines before a chunk also give it a disjoint range of
+        // edge slots to fill.
+        parallel::ThreadPool pool(num_chunks);
+        auto no_state = []()
+        { return 0; };
+        std::vector<std::size_t> line_counts(num_chunks);
+        parallel::for_each_index(pool, num_chunks, no_state, [&](int &, std::size_t chunk)
+                                 { line_counts[chunk] = std::count(bounds[chunk], bounds[chunk + 1], '\n'); });
+        std::vector<std::size_t> first_lines(num_chunks), first_slots(num_chunks);
+        std::size_t slot = builder.get_num_edges();
+        for (std::size_t chunk = 0; chunk < num_chunks; chunk++)
         {
-            if (line.empty() && !vertices.empty())
+            first_lines[chunk] = line_number;
+            first_slots[chunk] = slot;
+            line_number += line_counts[chunk];
+            slot += line_counts[chunk];
+        }
+        builder.resize_edges(slot + 1); // The last line may lack a newline
+
+        // Parse the chunks into their slots, the error of the earliest failing chunk is the one a
+        // sequential parse reports
+        std::vector<std::size_t> edge_counts(num_chunks, 0);
+        std::vector<std::exception_ptr> errors(num_chunks);
+        parallel::for_each_index(pool, num_chunks, no_state, [&](int &, std::size_t chunk)
+                                 {
+            try
             {
-                break; // Stop reading for vertices
+                std::size_t next_slot = first_slots[chunk];
+                parse_edges(bounds[chunk], bounds[chunk + 1], first_lines[chunk], [&](unsigned int source, unsigned int target, double cost)
+                            { builder.set_edge(next_slot++, source, target, cost); });
+                edge_counts[chunk] = next_slot - first_slots[chunk];
             }
-            if (line.empty() || line[0] == '#')
+            catch (...)
             {
-                continue; // Skip empty lines and comments
-            }
-            unsigned int vertex_id;
-            T x, y;
-            std::stringstream ss(line);
-            ss >> vertex_id >> x >> y;
-            vertices.emplace_back(vertex_id, x, y);
+                errors[chunk] = std::current_exception();
+            } });
+        for (const auto &error : errors)
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // Close the gaps left by comments and blank lines, usually there are none and nothing moves
+        std::size_t destination = first_slots[0];
+        for (std::size_t chunk = 0; chunk < num_chunks; chunk++)
+        {
+            if (first_slots[chunk] != destination)
+                builder.move_edges(first_slots[chunk], first_slots[chunk] + edge_counts[chunk], destination);
+            destination += edge_counts[chunk];
         }
+        builder.resize_edges(destination);
     }
 
+    // Parse edge lines and pass every edge to emit, line_number is the number of the line preceding begin
     template <class T>
-    inline void GraphFileReader<T>::read_edges()
+    template <class Emit>
+    inline void GraphFileReader<T>::parse_edges(const char *begin, const char *end, std::size_t line_number, Emit emit) const
     {
-        std::string line;
-        while (std::getline(file, line))
+        for (const char *line = begin; line < end;)
         {
-            if (line.empty() || line[0] == '#')
+            const char *newline = static_cast<const char *>(std::memchr(line, '\n', end - line));
+            const char *line_end = newline ? newline : end;
+            line_number++;
+
+            const char *current = line;
+            while (current < line_end && (*current == ' ' || *current == '\t' || *current == '\r'))
+                current++;
+            if (current != line_end && *current != '#')
             {
-                continue; // Skip empty lines and comments
+                unsigned int src_vertex, dest_vertex;
+                double cost;
+                parse_field(current, line_end, src_vertex, line_number, "source vertex");
+                parse_field(current, line_end, dest_vertex, line_number, "destination vertex");
+                parse_field(current, line_end, cost, line_number, "edge cost");
+                check_line_end(current, line_end, line_number);
+                emit(src_vertex, dest_vertex, cost);
             }
-            double cost;
-            unsigned int src_vertex, dest_vertex;
-            std::stringstream ss(line);
-            ss >> src_vertex >> dest_vertex >> cost;
-            edges.emplace_back(src_vertex, dest_vertex, cost);
+            line = newline ? newline + 1 : end;
         }
     }
 
     template <class T>
-    inline typename GraphFileReader<T>::StartEndInfo GraphFileReader<T>::get_start_end()
+    template <class Value>
+    inline void GraphFileReader<T>::parse_field(const char *&current, const char *line_end, Value &value, std::size_t line_number, const char *field) const
     {
-        return start_end;
+        while (current < line_end && (*current == ' ' || *current == '\t'))
+            current++;
+        if (current < line_end && *current == '+')
+            current++; // Accepted by the stream parser this replaces
+        auto result = std::from_chars(current, line_end, value);
+        if (result.ec != std::errc())
+        {
+            throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": expected " + field);
+        }
+        current = result.ptr;
     }
 
+    // Only whitespace (a CRLF ending included) may follow the last field of a line
     template <class T>
-    inline std::vector<typename GraphFileReader<T>::VertexInfo> GraphFileReader<T>::get_vertices()
+    inline void GraphFileReader<T>::check_line_end(const char *current, const char *line_end, std::size_t line_number) const
     {
-        return vertices;
+        while (current < line_end && (*current == ' ' || *current == '\t' || *current == '\r'))
+            current++;
+        if (current != line_end)
+        {
+            throw std::runtime_error(filename + ":" + std::to_string(line_number) + ": unexpected text after the last field");
+        }
     }
 
     template <class T>
-    inline std::vector<typename GraphFileReader<T>::EdgeInfo> GraphFileReader<T>::get_edges()
+    inline typename GraphFileReader<T>::StartEndInfo GraphFileReader<T>::get_start_end() const
     {
-        return edges;
+        return start_end;
     }
 } // namespace parser
 
-#endif // READER_H
\ No newline at end of file
+#endif // READER_H
@@ -0,0 +1,332 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include "../graph/csr_graph.hpp"
+#include "mapped_file.hpp"
+
+using namespace graph;
+
+namespace parser
+{
+    // Binary graph snapshot: a fixed header, a section table, then every section aligned to 64 bytes.
+    // The CSR sections are the raw arrays of CSRGraph in native byte order, so loading maps the file and
+    // points the graph at the pages without parsing or copying anything.
+    enum class SnapshotSection : std::uint32_t
+    {
+        POSITIONS = 1,
+        X_COORDINATES = 2,
+        Y_COORDINATES = 3,
+        OFFSETS = 4,
+        TARGETS = 5,
+        COSTS = 6,
+        REVERSE_OFFSETS = 7,
+        REVERSE_SOURCES = 8,
+        REVERSE_EDGES = 9,
+        LANDMARKS = 256 // Optional, a LandmarkTable as written by LandmarkTable::save
+    };
+
+    struct SnapshotHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;      // BYTE_ORDER_MARK as written by the producing machine
+        std::uint32_t coordinate_size; // sizeof(T) of the coordinates
+        std::uint32_t section_count;
+        std::uint64_t num_vertices;
+        std::uint64_t num_edges;
+        std::uint32_t start;
+        std::uint32_t end;
+        std::uint8_t reserved[16];
+    };
+
+    struct SnapshotSectionEntry
+    {
+        std::uint32_t id;
+        std::uint32_t element_size;
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 64, "Snapshot header layout changed");
+    static_assert(sizeof(SnapshotSectionEntry) == 24, "Snapshot section entry layout changed");
+
+    constexpr char SNAPSHOT_MAGIC[8] = {'P', 'F', 'G', 'R', 'A', 'P', 'H', '\0'};
+    constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+    constexpr std::uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+    constexpr std::uint64_t SNAPSHOT_ALIGNMENT = 64;
+
+    // Optional section to store alongside the graph
+    struct SnapshotExtra
+    {
+        SnapshotSection id;
+        std::string bytes;
+    };
+
+    // A loaded snapshot. The graph arrays and the extra sections point into the mapped file, which
+    // stays mapped as long as the graph or any copy of it is alive.
+    template <class T>
+    struct GraphSnapshot
+    {
+        std::tuple<unsigned int, unsigned int> start_end;
+        CSRGraph<T> csr;
+        std::vector<std::pair<SnapshotSection, std::string_view>> extras;
+        std::shared_ptr<const MappedFile> file;
+
+        bool has_section(SnapshotSection id) const;
+        std::string_view get_section(SnapshotSection id) const;
+    };
+
+    template <class T>
+    inline bool GraphSnapshot<T>::has_section(SnapshotSection id) const
+    {
+        for (const auto &extra : extras)
+        {
+            if (extra.first == id)
+                return true;
+        }
+        return false;
+    }
+
+    template <class T>
+    inline std::string_view GraphSnapshot<T>::get_section(SnapshotSection id) const
+    {
+        for (const auto &extra : extras)
+        {
+            if (extra.first == id)
+                return extra.second;
+        }
+        throw std::out_of_range("Snapshot section not found");
+    }
+
+    // Whether the file starts with the snapshot magic, text graph files never do
+    inline bool is_snapshot(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[sizeof(SNAPSHOT_MAGIC)];
+        return file.read(magic, sizeof(magic)) && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    }
+
+    template <class T>
+    void write_snapshot(const std::string &filename, const CSRGraph<T> &csr, std::tuple<unsigned int, unsigned int> start_end,
+                        const std::vector<SnapshotExtra> &extras = {})
+    {
+        const auto arrays = csr.get_arrays();
+
+        // Payload of every section, CSR arrays first
+        struct Payload
+        {
+            SnapshotSection id;
+            std::uint32_t element_size;
+            const char *data;
+            std::uint64_t count;
+        };
+        auto payload = [](SnapshotSection id, const auto &storage)
+        {
+            using Value = std::remove_cv_t<std::remove_reference_t<decltype(storage[0])>>;
+            return Payload{id, sizeof(Value), reinterpret_cast<const char *>(storage.data()), storage.size()};
+        };
+        std::vector<Payload> payloads{
+            payload(SnapshotSection::POSITIONS, arrays.positions),
+            payload(SnapshotSection::X_COORDINATES, arrays.xs),
+            payload(SnapshotSection::Y_COORDINATES, arrays.ys),
+            payload(SnapshotSection::OFFSETS, arrays.offsets),
+            payload(SnapshotSection::TARGETS, arrays.targets),
+            payload(SnapshotSection::COSTS, arrays.costs),
+            payload(SnapshotSection::REVERSE_OFFSETS, arrays.reverse_offsets),
+            payload(SnapshotSection::REVERSE_SOURCES, arrays.reverse_sources),
+            payload(SnapshotSection::REVERSE_EDGES, arrays.reverse_edges)};
+        for (const auto &extra : extras)
+            payloads.push_back(Payload{extra.id, 1, extra.bytes.data(), extra.bytes.size()});
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.byte_order = SNAPSHOT_BYTE_ORDER_MARK;
+        header.coordinate_size = sizeof(T);
+        header.section_count = payloads.size();
+        header.num_vertices = csr.get_num_vertices();
+        header.num_edges = csr.get_num_edges();
+        std::tie(header.start, header.end) = start_end;
+
+        // Lay the sections out after the table, each starting on an aligned offset
+        auto align = [](std::uint64_t offset)
+        { return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT; };
+        std::vector<SnapshotSectionEntry> entries;
+        std::uint64_t offset = align(sizeof(SnapshotHeader) + payloads.size() * sizeof(SnapshotSectionEntry));
+        for (const auto &section : payloads)
+        {
+            entries.push_back(SnapshotSectionEntry{static_cast<std::uint32_t>(section.id), section.element_size, offset, section.count});
+            offset = align(offset + section.count * section.element_size);
+        }
+
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error opening file: " + filename);
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(SnapshotSectionEntry));
+        std::uint64_t written = sizeof(header) + entries.size() * sizeof(SnapshotSectionEntry);
+        const char padding[SNAPSHOT_ALIGNMENT] = {};
+        for (std::size_t i = 0; i < payloads.size(); i++)
+        {
+            file.write(padding, entries[i].offset - written);
+            file.write(payloads[i].data, payloads[i].count * payloads[i].element_size);
+            written = entries[i].offset + payloads[i].count * payloads[i].element_size;
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Error writing file: " + filename);
+        }
+    }
+
+    // The mapped arrays are used as they are, so check once that every index they hold stays in bounds:
+    // positions strictly ascending, offsets non-decreasing from 0, and vertex and edge references below
+    // the vertex and edge counts. One linear pass, a corrupt file fails here instead of in a search.
+    template <class T>
+    void validate_snapshot_csr(const CSRGraph<T> &csr, const std::string &filename)
+    {
+        const auto arrays = csr.get_arrays();
+        const std::size_t num_vertices = csr.get_num_vertices();
+        const std::size_t num_edges = csr.get_num_edges();
+        auto fail = [&](const std::string &what)
+        {
+            throw std::runtime_error("Corrupt graph snapshot (" + what + "): " + filename);
+        };
+
+        for (std::size_t i = 1; i < num_vertices; i++)
+        {
+            if (arrays.positions[i - 1] >= arrays.positions[i])
+                fail("vertex positions not ascending");
+        }
+        if (arrays.offsets[0] != 0 || arrays.reverse_offsets[0] != 0)
+            fail("offsets do not start at 0");
+        for (std::size_t i = 0; i < num_vertices; i++)
+        {
+            if (arrays.offsets[i] > arrays.offsets[i + 1] || arrays.reverse_offsets[i] > arrays.reverse_offsets[i + 1])
+                fail("decreasing offsets");
+        }
+        for (std::size_t i = 0; i < num_edges; i++)
+        {
+            if (arrays.targets[i] >= num_vertices || arrays.reverse_sources[i] >= num_vertices)
+                fail("edge vertex out of range");
+            if (arrays.reverse_edges[i] >= num_edges)
+                fail("reverse edge out of range");
+        }
+    }
+
+    template <class T>
+    GraphSnapshot<T> load_snapshot(const std::string &filename)
+    {
+        auto file = std::make_shared<const MappedFile>(filename, false);
+        const char *data = file->data();
+        const std::size_t size = file->size();
+
+        SnapshotHeader header;
+        if (size < sizeof(header))
+        {
+            throw std::runtime_error("Not a graph snapshot: " + filename);
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        {
+            throw std::runtime_error("Not a graph snapshot: " + filename);
+        }
+        if (header.version != SNAPSHOT_VERSION || header.byte_order != SNAPSHOT_BYTE_ORDER_MARK || header.coordinate_size != sizeof(T))
+        {
+            throw std::runtime_error("Incompatible graph snapshot (version, byte order or coordinate type): " + filename);
+        }
+        if (sizeof(header) + header.section_count * sizeof(SnapshotSectionEntry) > size)
+        {
+            throw std::runtime_error("Truncated graph snapshot: " + filename);
+        }
+
+        GraphSnapshot<T> snapshot;
+        snapshot.start_end = std::make_tuple(header.start, header.end);
+        snapshot.file = file;
+        typename CSRGraph<T>::Arrays arrays;
+
+        // Point a CSR array at its section after checking it lies inside the file
+        auto view = [&](const SnapshotSectionEntry &entry, auto &storage)
+        {
+            using Value = std::remove_cv_t<std::remove_reference_t<decltype(storage[0])>>;
+            if (entry.element_size != sizeof(Value) || entry.offset % alignof(Value) != 0 ||
+                entry.offset > size || entry.count > (size - entry.offset) / sizeof(Value))
+            {
+                throw std::runtime_error("Corrupt graph snapshot section " + std::to_string(entry.id) + ": " + filename);
+            }
+            using Storage = std::remove_reference_t<decltype(storage)>;
+            storage = Storage(reinterpret_cast<const Value *>(data + entry.offset), entry.count, file);
+        };
+
+        unsigned int found = 0;
+        for (std::uint32_t i = 0; i < header.section_count; i++)
+        {
+            SnapshotSectionEntry entry;
+            std::memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+            switch (static_cast<SnapshotSection>(entry.id))
+            {
+            case SnapshotSection::POSITIONS:
+                view(entry, arrays.positions);
+                break;
+            case SnapshotSection::X_COORDINATES:
+                view(entry, arrays.xs);
+                break;
+            case SnapshotSection::Y_COORDINATES:
+                view(entry, arrays.ys);
+                break;
+            case SnapshotSection::OFFSETS:
+                view(entry, arrays.offsets);
+                break;
+            case SnapshotSection::TARGETS:
+                view(entry, arrays.targets);
+                break;
+            case SnapshotSection::COSTS:
+                view(entry, arrays.costs);
+                break;
+            case SnapshotSection::REVERSE_OFFSETS:
+                view(entry, arrays.reverse_offsets);
+                break;
+            case SnapshotSection::REVERSE_SOURCES:
+                view(entry, arrays.reverse_sources);
+                break;
+            case SnapshotSection::REVERSE_EDGES:
+                view(entry, arrays.reverse_edges);
+                break;
+            default:
+                // Optional sections are exposed as raw bytes, unknown ones are kept for newer readers
+                if (entry.offset > size || (entry.element_size != 0 && entry.count > (size - entry.offset) / entry.element_size))
+                {
+                    throw std::runtime_error("Corrupt graph snapshot section " + std::to_string(entry.id) + ": " + filename);
+                }
+                snapshot.extras.emplace_back(static_cast<SnapshotSection>(entry.id), std::string_view(data + entry.offset, entry.count * entry.element_size));
+                continue;
+            }
+            found++;
+        }
+        if (found != 9)
+        {
+            throw std::runtime_error("Graph snapshot is missing CSR sections: " + filename);
+        }
+
+        snapshot.csr = CSRGraph<T>(std::move(arrays));
+        if (snapshot.csr.get_num_vertices() != header.num_vertices || snapshot.csr.get_num_edges() != header.num_edges)
+        {
+            throw std::runtime_error("Graph snapshot sizes do not match its header: " + filename);
+        }
+        validate_snapshot_csr(snapshot.csr, filename);
+        return snapshot;
+    }
+} // namespace parser
+
+#endif // SNAPSHOT_H
@@ -4,10 +4,35 @@
 #include <fstream>
 #include <vector>
 #include <tuple>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <limits>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace parser
 {
+    // Line formatting of the graph file format, shared by GraphFileWriter and by code that formats
+    // lines in parallel chunks. Numbers are written with std::to_chars, the shortest text that reads
+    // back to the same value.
+    template <class Value>
+    void append_number(std::string &text, Value value);
+    template <class T>
+    void append_vertex_line(std::string &text, unsigned int position, T x, T y);
+    inline void append_edge_line(std::string &text, unsigned int source, unsigned int target, double cost);
+
+    // Writes graph files and path, batch and matrix results. Lines are formatted with std::to_chars into a large
+    // buffer, so numbers keep their full precision (the shortest text that reads back to the same
+    // value) and the file is written in big blocks instead of being flushed line by line.
+    //
+    // An async writer hands full buffers to a background thread, so the caller keeps formatting (and
+    // computing) while the disk catches up. At most MAX_PENDING buffers wait, which bounds memory.
+    // Everything is written out by close() or the destructor; only close() reports write errors.
     template <class T>
     class GraphFileWriter
     {
@@ -17,68 +42,360 @@ namespace parser
         using StartEndInfo = std::tuple<unsigned int, unsigned int>;
         using EdgeInfo = std::tuple<unsigned int, unsigned int, double>;
 
-        GraphFileWriter(const std::string &filename);
+        static constexpr std::size_t BUFFER_SIZE = std::size_t(1) << 20;
+        static constexpr std::size_t MAX_PENDING = 4;
+
+        GraphFileWriter(const std::string &filename, bool async = false);
+        ~GraphFileWriter();
+        GraphFileWriter(const GraphFileWriter &) = delete;
+        GraphFileWriter &operator=(const GraphFileWriter &) = delete;
+
         void write_start_end(const StartEndInfo &start_end);
         void write_vertices(const std::vector<VertexInfo> &vertices);
         void write_edges(const std::vector<EdgeInfo> &edges, std::string name = "optimal path");
         void write_cost_distance(const double cost, const ValueType distance);
+        void write_batch_header();
+        void write_batch_result(unsigned int start, unsigned int end, double cost, const std::vector<unsigned int> &path);
+        void write_matrix(const std::vector<unsigned int> &sources, const std::vector<unsigned int> &targets, const std::vector<double> &costs);
+
+        // A graph file section written piecewise: a "# title" line, blocks of complete lines formatted
+        // elsewhere (for instance with append_vertex_line on worker threads), then a blank line
+        void write_section_header(std::string_view title);
+        void write_lines(std::string_view lines);
+        void end_section();
+
+        // Write out everything buffered and close the file, throws if any write failed
+        void close();
 
     private:
+        std::string filename;
         std::ofstream file;
+        std::string buffer;
+        bool closed = false;
+
+        // Async mode only, guarded by the mutex
+        std::thread writer;
+        std::mutex mutex;
+        std::condition_variable buffer_filled;
+        std::condition_variable buffer_written;
+        std::deque<std::string> pending;
+        std::vector<std::string> spare;
+        bool stopping = false;
+
+        void append(std::string_view text);
+        template <class Value>
+        void append_number(Value value);
+        void append_cost(double cost);
+        void end_line();
+        void flush_buffer();
+        void write_loop();
     };
 
+    template <class Value>
+    inline void append_number(std::string &text, Value value)
+    {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        text.append(digits, result.ptr);
+    }
+
+    template <class T>
+    inline void append_vertex_line(std::string &text, unsigned int position, T x, T y)
+    {
+        append_number(text, position);
+        text.push_back(' ');
+        append_number(text, x);
+        text.push_back(' ');
+        append_number(text, y);
+        text.push_back('\n');
+    }
+
+    inline void append_edge_line(std::string &text, unsigned int source, unsigned int target, double cost)
+    {
+        append_number(text, source);
+        text.push_back(' ');
+        append_number(text, target);
+        text.push_back(' ');
+        append_number(text, cost);
+        text.push_back('\n');
+    }
+
     template <class T>
-    GraphFileWriter<T>::GraphFileWriter(const std::string &filename) : file(filename)
+    GraphFileWriter<T>::GraphFileWriter(const std::string &filename, bool async) : filename(filename), file(filename, std::ios::binary)
     {
         if (!file)
         {
             throw std::runtime_error("Error opening file: " + filename);
         }
+        buffer.reserve(BUFFER_SIZE + 256);
+        if (async)
+            writer = std::thread(&GraphFileWriter::write_loop, this);
+    }
+
+    template <class T>
+    GraphFileWriter<T>::~GraphFileWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+            // Destructors must not throw, call close() to see write errors
+        }
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::close()
+    {
+        if (closed)
+            return;
+        closed = true;
+        flush_buffer();
+        if (writer.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            buffer_filled.notify_one();
+            writer.join();
+        }
+        file.close();
+        if (!file)
+        {
+            throw std::runtime_error("Error writing file: " + filename);
+        }
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::append(std::string_view text)
+    {
+        buffer.append(text);
+    }
+
+    template <class T>
+    template <class Value>
+    void GraphFileWriter<T>::append_number(Value value)
+    {
+        parser::append_number(buffer, value);
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::append_cost(double cost)
+    {
+        // Unreachable pairs are written as -1
+        append_number(cost == std::numeric_limits<double>::infinity() ? -1.0 : cost);
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::end_line()
+    {
+        buffer.push_back('\n');
+        if (buffer.size() >= BUFFER_SIZE)
+            flush_buffer();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_section_header(std::string_view title)
+    {
+        append("# ");
+        append(title);
+        end_line();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_lines(std::string_view lines)
+    {
+        buffer.append(lines);
+        if (buffer.size() >= BUFFER_SIZE)
+            flush_buffer();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::end_section()
+    {
+        end_line();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::flush_buffer()
+    {
+        if (buffer.empty())
+            return;
+        if (!writer.joinable())
+        {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        buffer_written.wait(lock, [&]()
+                            { return pending.size() < MAX_PENDING; });
+        pending.push_back(std::move(buffer));
+        if (spare.empty())
+        {
+            buffer = std::string();
+            buffer.reserve(BUFFER_SIZE + 256);
+        }
+        else
+        {
+            buffer = std::move(spare.back());
+            spare.pop_back();
+        }
+        lock.unlock();
+        buffer_filled.notify_one();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            buffer_filled.wait(lock, [&]()
+                               { return stopping || !pending.empty(); });
+            if (pending.empty())
+                return;
+            std::string block = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            file.write(block.data(), block.size());
+            block.clear();
+            lock.lock();
+            spare.push_back(std::move(block));
+            buffer_written.notify_one();
+        }
     }
 
     template <class T>
     void GraphFileWriter<T>::write_start_end(const StartEndInfo &start_end)
     {
-        file << "# Start and end vertices" << std::endl;
-        unsigned int start, end;
-        std::tie(start, end) = start_end;
-        file << start << " " << end << std::endl
-             << std::endl;
+        append("# Start and end vertices");
+        end_line();
+        append_number(std::get<0>(start_end));
+        append(" ");
+        append_number(std::get<1>(start_end));
+        end_line();
+        end_line();
     }
 
     template <class T>
     void GraphFileWriter<T>::write_vertices(const std::vector<VertexInfo> &vertices)
     {
-        file << "# Vertices" << std::endl;
-        for (auto& vertex : vertices) 
+        write_section_header("Vertices");
+        for (const auto &vertex : vertices)
         {
-            unsigned int pos, x, y;
-            std::tie(pos, x, y) = vertex;
-            file << pos << " " << x << " " << y << std::endl;
+            append_vertex_line(buffer, std::get<0>(vertex), std::get<1>(vertex), std::get<2>(vertex));
+            if (buffer.size() >= BUFFER_SIZE)
+                flush_buffer();
         }
-        file << std::endl;
+        end_section();
     }
 
     template <class T>
     void GraphFileWriter<T>::write_edges(const std::vector<EdgeInfo> &edges, std::string name)
     {
-        file << "# " << name << " edges" << std::endl;
+        write_section_header(name + " edges");
         for (const auto &edge : edges)
         {
-            double cost;
-            int src_vertex, dest_vertex;
-            std::tie(src_vertex, dest_vertex, cost) = edge;
-            file << src_vertex << " " << dest_vertex << " " << cost << std::endl;
+            append_edge_line(buffer, std::get<0>(edge), std::get<1>(edge), std::get<2>(edge));
+            if (buffer.size() >= BUFFER_SIZE)
+                flush_buffer();
         }
-        file << std::endl;
+        end_section();
     }
 
     template <class T>
     void GraphFileWriter<T>::write_cost_distance(const double cost, const ValueType distance)
     {
-        file << "# Cost and distance" << std::endl;
-        file << cost << " " << distance << std::endl
-             << std::endl;
+        append("# Cost and distance");
+        end_line();
+        append_number(cost);
+        append(" ");
+        append_number(distance);
+        end_line();
+        end_line();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_batch_header()
+    {
+        append("# Batch results (start end cost path), cost -1 when there is no path");
+        end_line();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_batch_result(unsigned int start, unsigned int end, double cost, const std::vector<unsigned int> &path)
+    {
+        append_number(start);
+        append(" ");
+        append_number(end);
+        append(" ");
+        append_cost(cost);
+        for (auto position : path)
+        {
+            append(" ");
+            append_number(position);
+        }
+        end_line();
+    }
+
+    template <class T>
+    void GraphFileWriter<T>::write_matrix(const std::vector<unsigned int> &sources, const std::vector<unsigned int> &targets, const std::vector<double> &costs)
+    {
+        // A "rows columns" line, the target positions, then one line per source: its position followed by its row
+        append("# Distance matrix (rows: sources, columns: targets), cost -1 when there is no path");
+        end_line();
+        append_number(sources.size());
+        append(" ");
+        append_number(targets.size());
+        end_line();
+        for (std::size_t column = 0; column < targets.size(); column++)
+        {
+            if (column > 0)
+                append(" ");
+            append_number(targets[column]);
+        }
+        end_line();
+        for (std::size_t row = 0; row < sources.size(); row++)
+        {
+            append_number(sources[row]);
+            for (std::size_t column = 0; column < targets.size(); column++)
+            {
+                append(" ");
+                append_cost(costs[row * targets.size() + column]);
+            }
+            end_line();
+        }
+        end_line();
+    }
+
+    constexpr char MATRIX_MAGIC[8] = {'P', 'F', 'M', 'A', 'T', 'R', 'I', 'X'};
+
+    // Native-endian binary matrix: the magic, the row and column counts as 64-bit integers, then the
+    // row-major costs as doubles. Unreachable pairs keep their infinite cost.
+    inline void write_binary_matrix(const std::string &filename, std::size_t num_rows, std::size_t num_columns, const std::vector<double> &costs)
+    {
+        if (costs.size() != num_rows * num_columns)
+        {
+            throw std::invalid_argument("The matrix has " + std::to_string(costs.size()) + " costs, expected " + std::to_string(num_rows) + " x " +
+                                        std::to_string(num_columns));
+        }
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Error opening file: " + filename);
+        }
+        const std::uint64_t dimensions[2] = {num_rows, num_columns};
+        file.write(MATRIX_MAGIC, sizeof(MATRIX_MAGIC));
+        file.write(reinterpret_cast<const char *>(dimensions), sizeof(dimensions));
+        file.write(reinterpret_cast<const char *>(costs.data()), costs.size() * sizeof(double));
+        if (!file)
+        {
+            throw std::runtime_error("Error writing file: " + filename);
+        }
     }
 } // namespace parser
 